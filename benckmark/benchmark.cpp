@@ -13,16 +13,110 @@
 #include <atomic>
 #include <cstring>
 #include <mutex>
+#include <cstdlib>
+#include <new>
 
 #include "../tqdm.h"
 
 #ifdef __linux__
 #include <sys/resource.h>
 #include <unistd.h>
+#include <pthread.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
 #endif
 
 namespace benchmark {
 
+// -------------------- AllocationCounter --------------------
+// Counts calls (and requested bytes) into the replaced global operator new
+// below.
+struct AllocationCounter {
+    static std::atomic<size_t>& count() {
+        static std::atomic<size_t> n{0};
+        return n;
+    }
+    static std::atomic<size_t>& bytes() {
+        static std::atomic<size_t> n{0};
+        return n;
+    }
+    static size_t now() { return count().load(std::memory_order_relaxed); }
+    static size_t bytes_now() { return bytes().load(std::memory_order_relaxed); }
+};
+
+} // namespace benchmark
+
+// Kept out of line so the compiler does not pair inlined new-expressions
+// with free() and warn about a mismatch.
+#if defined(__GNUC__)
+#  define BENCH_NOINLINE __attribute__((noinline))
+#else
+#  define BENCH_NOINLINE
+#endif
+
+BENCH_NOINLINE void* operator new(std::size_t size) {
+    benchmark::AllocationCounter::count().fetch_add(1, std::memory_order_relaxed);
+    benchmark::AllocationCounter::bytes().fetch_add(size, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+BENCH_NOINLINE void operator delete(void* p) noexcept { std::free(p); }
+BENCH_NOINLINE void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+#ifdef __cpp_aligned_new
+// Over-aligned types (the tracker's cache-line aligned members) use these.
+BENCH_NOINLINE void* operator new(std::size_t size, std::align_val_t align) {
+    benchmark::AllocationCounter::count().fetch_add(1, std::memory_order_relaxed);
+    benchmark::AllocationCounter::bytes().fetch_add(size, std::memory_order_relaxed);
+    auto a = static_cast<std::size_t>(align);
+    if (void* p = std::aligned_alloc(a, (size + a - 1) / a * a)) return p;
+    throw std::bad_alloc();
+}
+BENCH_NOINLINE void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+BENCH_NOINLINE void operator delete(void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+#endif
+
+namespace benchmark {
+
+// -------------------- Options --------------------
+// Command-line settings shared by the runner and the reporters.
+struct Options {
+    std::string filter;          // run only benchmarks whose name contains this
+    std::string json_path;       // write results as JSON
+    std::string csv_path;        // write results as CSV
+    std::string baseline_path;   // CSV from an earlier run to compare against
+    double threshold_pct{10.0};  // slowdown that counts as a regression
+    double min_time_s{1.0};      // sampling time per benchmark
+    bool pin{false};             // pin benchmark threads to CPUs
+};
+
+static Options& options() {
+    static Options o;
+    return o;
+}
+
+static bool selected(const std::string& name) {
+    return options().filter.empty() || name.find(options().filter) != std::string::npos;
+}
+
+// Pins the calling thread to CPU `index` (modulo the CPU count) when --pin
+// is given, so contention runs are not skewed by migrations.
+static void pin_thread(size_t index) {
+#ifdef __linux__
+    if (!options().pin) return;
+    size_t cpus = std::max(1u, std::thread::hardware_concurrency());
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(static_cast<int>(index % cpus), &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+    (void)index;
+#endif
+}
+
 // -------------------- Timer --------------------
 class Timer {
     using clock = std::chrono::high_resolution_clock;
@@ -80,6 +174,103 @@ public:
     }
 };
 
+// -------------------- PerfCounters --------------------
+// Per-benchmark hardware and scheduler counters through perf_event_open.
+// Counters are inherited by threads the benchmark starts. Any event the
+// kernel refuses (no PMU in a VM, perf_event_paranoid, non-Linux) reads as
+// unavailable and is shown as N/A.
+class PerfCounters {
+public:
+    enum Event { CYCLES, INSTRUCTIONS, CACHE_MISSES, CONTEXT_SWITCHES, EVENT_COUNT };
+
+    struct Reading {
+        bool valid[EVENT_COUNT] = {};
+        double value[EVENT_COUNT] = {};
+    };
+
+private:
+    int fds_[EVENT_COUNT];
+
+#ifdef __linux__
+    static int open_event(uint32_t type, uint64_t config) {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = type;
+        attr.config = config;
+        attr.disabled = 1;
+        attr.inherit = 1;
+        attr.exclude_hv = 1;
+        attr.exclude_kernel = type == PERF_TYPE_HARDWARE;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        int fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, PERF_FLAG_FD_CLOEXEC));
+        if (fd < 0 && !attr.exclude_kernel) {
+            // perf_event_paranoid >= 2 allows user-space counting only
+            attr.exclude_kernel = 1;
+            fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, PERF_FLAG_FD_CLOEXEC));
+        }
+        return fd;
+    }
+#endif
+
+public:
+    PerfCounters() {
+        for (auto& fd : fds_) fd = -1;
+#ifdef __linux__
+        fds_[CYCLES] = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+        fds_[INSTRUCTIONS] = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+        fds_[CACHE_MISSES] = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+        fds_[CONTEXT_SWITCHES] = open_event(PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES);
+#endif
+    }
+
+    ~PerfCounters() {
+#ifdef __linux__
+        for (int fd : fds_) if (fd >= 0) close(fd);
+#endif
+    }
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    // Whether this process can count anything; probed once.
+    static bool available() {
+        static const bool any = [] {
+            PerfCounters probe;
+            for (int fd : probe.fds_) if (fd >= 0) return true;
+            return false;
+        }();
+        return any;
+    }
+
+    void start() {
+#ifdef __linux__
+        for (int fd : fds_) {
+            if (fd < 0) continue;
+            ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+
+    Reading stop() {
+        Reading r;
+#ifdef __linux__
+        for (int i = 0; i < EVENT_COUNT; ++i) {
+            if (fds_[i] < 0) continue;
+            ioctl(fds_[i], PERF_EVENT_IOC_DISABLE, 0);
+            uint64_t data[3] = {0, 0, 0};  // value, time enabled, time running
+            if (read(fds_[i], data, sizeof(data)) != static_cast<ssize_t>(sizeof(data))) continue;
+            // Scale for multiplexing when more events than counters are active
+            double scale = data[2] > 0 ? static_cast<double>(data[1]) / static_cast<double>(data[2]) : 0.0;
+            r.valid[i] = data[2] > 0;
+            r.value[i] = static_cast<double>(data[0]) * scale;
+        }
+#endif
+        return r;
+    }
+};
+
 // -------------------- Statistics --------------------
 class Statistics {
     std::vector<double> samples_; // seconds per run
@@ -106,6 +297,72 @@ public:
     }
 };
 
+// -------------------- LatencyHistogram --------------------
+// Log-linear histogram of nanosecond latencies: exact below 16 ns, then 16
+// sub-buckets per power of two (under 6.25% error). Percentiles report the
+// upper edge of their bucket. One histogram per thread, merged afterwards.
+class LatencyHistogram {
+    static constexpr unsigned SUB_BITS = 4;
+    static constexpr uint64_t SUB_COUNT = uint64_t(1) << SUB_BITS;
+
+    std::vector<uint64_t> counts_;
+    uint64_t total_{0};
+    uint64_t max_{0};
+
+    static unsigned msb(uint64_t v) {
+#if defined(__GNUC__)
+        return 63u - static_cast<unsigned>(__builtin_clzll(v));
+#else
+        unsigned n = 0;
+        while (v >>= 1) ++n;
+        return n;
+#endif
+    }
+
+    static size_t index(uint64_t v) {
+        if (v < SUB_COUNT) return static_cast<size_t>(v);
+        unsigned shift = msb(v) - SUB_BITS;
+        return static_cast<size_t>((shift + 1) * SUB_COUNT + ((v >> shift) - SUB_COUNT));
+    }
+
+    static uint64_t upper_edge(size_t idx) {
+        if (idx < SUB_COUNT) return idx;
+        uint64_t shift = idx / SUB_COUNT - 1;
+        uint64_t mantissa = idx % SUB_COUNT + SUB_COUNT;
+        return ((mantissa + 1) << shift) - 1;
+    }
+
+public:
+    LatencyHistogram() : counts_((64 - SUB_BITS + 1) * SUB_COUNT, 0) {}
+
+    void record(uint64_t ns) {
+        ++counts_[index(ns)];
+        ++total_;
+        if (ns > max_) max_ = ns;
+    }
+
+    void merge(const LatencyHistogram& other) {
+        for (size_t i = 0; i < counts_.size(); ++i) counts_[i] += other.counts_[i];
+        total_ += other.total_;
+        max_ = std::max(max_, other.max_);
+    }
+
+    uint64_t count() const { return total_; }
+    uint64_t max() const { return max_; }
+
+    uint64_t percentile(double p) const {
+        if (total_ == 0) return 0;
+        auto target = static_cast<uint64_t>(std::ceil(p / 100.0 * static_cast<double>(total_)));
+        if (target == 0) target = 1;
+        uint64_t seen = 0;
+        for (size_t i = 0; i < counts_.size(); ++i) {
+            seen += counts_[i];
+            if (seen >= target) return std::min(upper_edge(i), max_);
+        }
+        return max_;
+    }
+};
+
 // -------------------- BenchmarkResult --------------------
 struct BenchmarkResult {
     std::string name;
@@ -125,6 +382,21 @@ struct BenchmarkResult {
     bool has_baseline{false};
     double baseline_mean_update_s{0.0};
     double delta_update_s{0.0}; // mean_update_s - baseline_mean_update_s
+
+    bool skipped{false};        // filtered out by --filter
+
+    // perf_event_open counters; negative when unavailable
+    double cycles_per_update{-1.0};
+    double instructions_per_update{-1.0};
+    double cache_misses_per_update{-1.0};
+    double context_switches_per_run{-1.0};
+
+    void compare_to(const BenchmarkResult& base) {
+        if (skipped || base.skipped) return;
+        has_baseline = true;
+        baseline_mean_update_s = base.mean_update_s;
+        delta_update_s = mean_update_s - base.mean_update_s;
+    }
 };
 
 // -------------------- Formatting helpers --------------------
@@ -165,8 +437,12 @@ public:
                   << std::setw(14) << "Max/update"
                   << std::setw(18) << "Delta vs base"
                   << std::setw(14) << "upd/s"
-                  << std::setw(12) << "Memory"
-                  << "\n" << std::string(161, '-') << "\n";
+                  << std::setw(12) << "Memory";
+        if (PerfCounters::available()) {
+            std::cout << std::setw(11) << "cyc/upd" << std::setw(11) << "ins/upd"
+                      << std::setw(11) << "miss/upd" << std::setw(10) << "cs/run";
+        }
+        std::cout << "\n" << std::string(PerfCounters::available() ? 204 : 161, '-') << "\n";
     }
 
     static void print_result(const BenchmarkResult& r) {
@@ -189,11 +465,24 @@ public:
         t << format_throughput(r.updates_per_second) << " upd/s";
         std::cout << std::setw(14) << t.str();
 
-        std::cout << std::setw(12) << MemoryTracker::format_bytes(r.memory_usage)
-                  << "\n";
+        std::cout << std::setw(12) << MemoryTracker::format_bytes(r.memory_usage);
+        if (PerfCounters::available()) {
+            std::cout << std::setw(11) << format_count(r.cycles_per_update)
+                      << std::setw(11) << format_count(r.instructions_per_update)
+                      << std::setw(11) << format_count(r.cache_misses_per_update)
+                      << std::setw(10) << format_count(r.context_switches_per_run);
+        }
+        std::cout << "\n";
     }
 
 private:
+    static std::string format_count(double v) {
+        if (v < 0) return "N/A";
+        std::ostringstream oss;
+        oss << std::fixed << std::setprecision(v < 10 ? 2 : 1) << v;
+        return oss.str();
+    }
+
     static std::string add_commas(size_t x) {
         std::string s = std::to_string(x);
         for (int i = static_cast<int>(s.size()) - 3; i > 0; i -= 3) s.insert(static_cast<size_t>(i), ",");
@@ -204,7 +493,6 @@ private:
 // -------------------- Runner --------------------
 class BenchmarkRunner {
     static constexpr size_t WARMUP_ITER = 50;
-    static constexpr double MIN_TIME_S = 1.0;
     static constexpr size_t MAX_SAMPLES = 1000;
 
 public:
@@ -213,20 +501,30 @@ public:
                                size_t iterations,
                                size_t threads,
                                Func&& fn) {
+        if (!selected(name)) {
+            BenchmarkResult skipped;
+            skipped.name = name;
+            skipped.skipped = true;
+            return skipped;
+        }
+
         // Warmup
         for (size_t i = 0; i < WARMUP_ITER; ++i) fn();
 
         MemoryTracker mem;
+        PerfCounters counters;
         Statistics stats;
         Timer wall;
         size_t samples = 0;
 
-        while (wall.elapsed() < MIN_TIME_S && samples < MAX_SAMPLES) {
+        counters.start();
+        while (wall.elapsed() < options().min_time_s && samples < MAX_SAMPLES) {
             Timer t;
             fn(); // one full run
             stats.add_sample(t.elapsed());
             ++samples;
         }
+        auto events = counters.stop();
 
         double mean_run_s = stats.mean();
         double stddev_run_s = stats.stddev();
@@ -248,11 +546,251 @@ public:
             r.min_update_s    = min_run_s / static_cast<double>(iterations);
             r.max_update_s    = max_run_s / static_cast<double>(iterations);
             r.updates_per_second = static_cast<double>(iterations) / mean_run_s;
+
+            double updates = static_cast<double>(iterations) * static_cast<double>(samples);
+            if (events.valid[PerfCounters::CYCLES])
+                r.cycles_per_update = events.value[PerfCounters::CYCLES] / updates;
+            if (events.valid[PerfCounters::INSTRUCTIONS])
+                r.instructions_per_update = events.value[PerfCounters::INSTRUCTIONS] / updates;
+            if (events.valid[PerfCounters::CACHE_MISSES])
+                r.cache_misses_per_update = events.value[PerfCounters::CACHE_MISSES] / updates;
         }
+        if (events.valid[PerfCounters::CONTEXT_SWITCHES] && samples > 0)
+            r.context_switches_per_run = events.value[PerfCounters::CONTEXT_SWITCHES] / static_cast<double>(samples);
         return r;
     }
 };
 
+// -------------------- Report --------------------
+// Collects every section's results (and single-value metrics such as
+// allocations per frame) for the table, JSON and CSV output, and compares
+// them with a baseline CSV from an earlier run.
+class Report {
+    struct Row {
+        std::string section;
+        BenchmarkResult result;
+        bool is_metric{false};
+        double value{0.0};
+        std::string unit;
+    };
+
+    static std::vector<Row>& rows() {
+        static std::vector<Row> r;
+        return r;
+    }
+
+    // Rows repeat names across thread counts, so the key includes them.
+    static std::string key(const std::string& section, const std::string& name, const std::string& threads) {
+        return threads.empty() ? section + "/" + name : section + "/" + name + " t=" + threads;
+    }
+
+    static std::string key(const Row& r) {
+        return key(r.section, r.result.name, r.is_metric ? std::string() : std::to_string(r.result.threads));
+    }
+
+    static std::string json_escape(const std::string& in) {
+        std::string out;
+        for (char c : in) {
+            if (c == '"' || c == '\\') out += '\\';
+            out += c;
+        }
+        return out;
+    }
+
+    static std::string csv_quote(const std::string& in) {
+        std::string out = "\"";
+        for (char c : in) {
+            if (c == '"') out += '"';
+            out += c;
+        }
+        return out + "\"";
+    }
+
+    static std::vector<std::string> csv_split(const std::string& line) {
+        std::vector<std::string> fields(1);
+        bool quoted = false;
+        for (size_t i = 0; i < line.size(); ++i) {
+            char c = line[i];
+            if (quoted) {
+                if (c == '"' && i + 1 < line.size() && line[i + 1] == '"') { fields.back() += '"'; ++i; }
+                else if (c == '"') quoted = false;
+                else fields.back() += c;
+            } else if (c == '"') {
+                quoted = true;
+            } else if (c == ',') {
+                fields.emplace_back();
+            } else {
+                fields.back() += c;
+            }
+        }
+        return fields;
+    }
+
+    // Per-update time in ns for results, the raw value for metrics.
+    static double compared_value(const Row& r) {
+        return r.is_metric ? r.value : r.result.mean_update_s * 1e9;
+    }
+
+    static void write_json(const std::string& path) {
+        std::ofstream out(path);
+        out << "{\n  \"results\": [";
+        bool first = true;
+        for (const auto& r : rows()) {
+            out << (first ? "\n" : ",\n");
+            first = false;
+            out << "    {\"section\": \"" << json_escape(r.section) << "\", \"name\": \""
+                << json_escape(r.result.name) << "\", ";
+            if (r.is_metric) {
+                out << "\"value\": " << r.value << ", \"unit\": \"" << json_escape(r.unit) << "\"}";
+                continue;
+            }
+            const auto& b = r.result;
+            out << "\"iterations\": " << b.iterations << ", \"threads\": " << b.threads
+                << ", \"mean_ns\": " << b.mean_update_s * 1e9
+                << ", \"stddev_ns\": " << b.stddev_update_s * 1e9
+                << ", \"min_ns\": " << b.min_update_s * 1e9
+                << ", \"max_ns\": " << b.max_update_s * 1e9;
+            if (b.has_baseline) out << ", \"delta_ns\": " << b.delta_update_s * 1e9;
+            out << ", \"updates_per_s\": " << b.updates_per_second
+                << ", \"memory_bytes\": " << b.memory_usage;
+            auto counter = [&out](const char* field, double v) {
+                if (v >= 0) out << ", \"" << field << "\": " << v;
+            };
+            counter("cycles_per_update", b.cycles_per_update);
+            counter("instructions_per_update", b.instructions_per_update);
+            counter("cache_misses_per_update", b.cache_misses_per_update);
+            counter("context_switches_per_run", b.context_switches_per_run);
+            out << "}";
+        }
+        out << "\n  ]\n}\n";
+    }
+
+    static void write_csv(const std::string& path) {
+        std::ofstream out(path);
+        out << "kind,section,name,iterations,threads,mean_ns,stddev_ns,min_ns,max_ns,delta_ns,"
+               "updates_per_s,memory_bytes,value,unit,cycles_per_update,instructions_per_update,"
+               "cache_misses_per_update,context_switches_per_run\n";
+        for (const auto& r : rows()) {
+            const auto& b = r.result;
+            out << (r.is_metric ? "metric" : "result") << ',' << csv_quote(r.section) << ','
+                << csv_quote(b.name) << ',';
+            if (r.is_metric) {
+                out << ",,,,,,,,," << r.value << ',' << csv_quote(r.unit) << ",,,,\n";
+                continue;
+            }
+            out << b.iterations << ',' << b.threads << ',' << b.mean_update_s * 1e9 << ','
+                << b.stddev_update_s * 1e9 << ',' << b.min_update_s * 1e9 << ','
+                << b.max_update_s * 1e9 << ',';
+            if (b.has_baseline) out << b.delta_update_s * 1e9;
+            out << ',' << b.updates_per_second << ',' << b.memory_usage << ",,";
+            for (double v : {b.cycles_per_update, b.instructions_per_update,
+                             b.cache_misses_per_update, b.context_switches_per_run}) {
+                out << ',';
+                if (v >= 0) out << v;
+            }
+            out << "\n";
+        }
+    }
+
+    // Prints one line per benchmark present in both runs; returns the number
+    // of regressions. Differences under 1 ns (or 1%) are treated as noise.
+    static size_t compare(const std::string& path) {
+        std::ifstream in(path);
+        if (!in) {
+            std::cerr << "Cannot read baseline " << path << "\n";
+            return 1;
+        }
+        std::vector<std::pair<std::string, double>> baseline;
+        std::string line;
+        std::getline(in, line);  // header
+        while (std::getline(in, line)) {
+            auto f = csv_split(line);
+            if (f.size() < 14) continue;
+            bool metric = f[0] == "metric";
+            const std::string& v = metric ? f[12] : f[5];
+            if (v.empty()) continue;
+            baseline.emplace_back(key(f[1], f[2], metric ? std::string() : f[4]), std::atof(v.c_str()));
+        }
+
+        std::cout << "\n\nComparison with " << path << " (threshold "
+                  << std::fixed << std::setprecision(1) << options().threshold_pct << "%):\n\n"
+                  << std::setw(56) << std::left << "Benchmark"
+                  << std::setw(14) << std::right << "Baseline"
+                  << std::setw(14) << "Current"
+                  << std::setw(10) << "Change" << "\n" << std::string(104, '-') << "\n";
+        size_t regressions = 0;
+        for (const auto& r : rows()) {
+            auto k = key(r);
+            auto it = std::find_if(baseline.begin(), baseline.end(),
+                                   [&k](const std::pair<std::string, double>& b) { return b.first == k; });
+            if (it == baseline.end()) continue;
+            double before = it->second, now = compared_value(r);
+            double change = before > 0 ? 100.0 * (now - before) / before : 0.0;
+            bool noise = r.is_metric ? std::fabs(now - before) < 0.01 * std::max(1.0, before)
+                                     : std::fabs(now - before) < 1.0;
+            bool regressed = !noise && change > options().threshold_pct;
+            if (regressed) ++regressions;
+            std::ostringstream b, c, d;
+            if (r.is_metric) {
+                b << std::fixed << std::setprecision(2) << before;
+                c << std::fixed << std::setprecision(2) << now;
+            } else {
+                b << format_seconds(before * 1e-9);
+                c << format_seconds(now * 1e-9);
+            }
+            d << std::fixed << std::showpos << std::setprecision(1) << change << "%";
+            auto label = r.result.name;
+            if (!r.is_metric && r.result.threads > 1) label += " t=" + std::to_string(r.result.threads);
+            std::cout << std::setw(56) << std::left << label.substr(0, 55)
+                      << std::setw(14) << std::right << b.str()
+                      << std::setw(14) << c.str()
+                      << std::setw(10) << d.str()
+                      << (regressed ? "  REGRESSION" : "") << "\n";
+        }
+        std::cout << "\n" << regressions << " regression(s)\n";
+        return regressions;
+    }
+
+public:
+    // Prints a section table and records its results.
+    static void section(const std::string& title, const std::vector<BenchmarkResult>& results) {
+        bool any = false;
+        for (const auto& r : results) {
+            if (r.skipped) continue;
+            if (!any) {
+                std::cout << "\n\n" << title << ":\n";
+                ResultFormatter::print_header();
+                any = true;
+            }
+            ResultFormatter::print_result(r);
+            Row row;
+            row.section = title;
+            row.result = r;
+            rows().push_back(row);
+        }
+    }
+
+    static void metric(const std::string& section, const std::string& name, double value,
+                       const std::string& unit) {
+        Row row;
+        row.section = section;
+        row.result.name = name;
+        row.is_metric = true;
+        row.value = value;
+        row.unit = unit;
+        rows().push_back(row);
+    }
+
+    // Writes the requested files and runs the baseline comparison; returns
+    // the process exit code.
+    static int finish() {
+        if (!options().json_path.empty()) write_json(options().json_path);
+        if (!options().csv_path.empty()) write_csv(options().csv_path);
+        if (!options().baseline_path.empty() && compare(options().baseline_path) > 0) return 1;
+        return 0;
+    }
+};
+
 } // namespace benchmark
 
 // -------------------- Utilities for baselines --------------------
@@ -267,22 +805,16 @@ static inline void spin_empty_work_batched(size_t total, size_t step) {
     for (size_t i = 0; i < total; i += step) sink += i;
 }
 
-// -------------------- Null display (tracker-only) --------------------
-class null_display : public tqdm::display_policy {
-public:
-    void render(const tqdm::progress_tracker<>&) override {}
-    void finish(const tqdm::progress_tracker<>&) override {}
-};
-
 // -------------------- ProgressBarManager with pluggable display --------------------
 class ProgressBarManager {
     std::unique_ptr<tqdm::progress_bar<>> bar_;
 public:
-    explicit ProgressBarManager(size_t total, std::unique_ptr<tqdm::display_policy> disp = nullptr) {
+    explicit ProgressBarManager(size_t total, std::unique_ptr<tqdm::display_policy> disp = nullptr,
+                                const tqdm::tracker_options& opts = tqdm::tracker_options()) {
         if (disp) {
-            bar_.reset(new tqdm::progress_bar<>(total, std::move(disp)));
+            bar_.reset(new tqdm::progress_bar<>(total, opts, std::move(disp)));
         } else {
-            bar_.reset(new tqdm::progress_bar<>(total)); // default display (TTY-aware)
+            bar_.reset(new tqdm::progress_bar<>(total, opts)); // default display (TTY-aware)
         }
     }
     void advance(size_t n = 1) { bar_->advance(n); }
@@ -293,6 +825,7 @@ public:
 using benchmark::BenchmarkRunner;
 using benchmark::BenchmarkResult;
 using benchmark::ResultFormatter;
+using benchmark::Report;
 
 static void print_system_info() {
     std::cout << "System Information:\n";
@@ -346,15 +879,41 @@ static void benchmark_single_thread() {
         auto r = BenchmarkRunner::run(
             "Single-thread advance(" + std::to_string(n) + ") [tracker-only]",
             n, 1, [n]() {
-                ProgressBarManager bar(n, std::make_unique<null_display>());
+                ProgressBarManager bar(n, std::make_unique<tqdm::null_display>());
                 for (size_t i = 0; i < n; ++i) bar.advance();
                 bar.finish();
             }
         );
-        r.has_baseline = true;
-        r.baseline_mean_update_s = base.mean_update_s;
-        r.delta_update_s = r.mean_update_s - base.mean_update_s;
+        r.compare_to(base);
         out.push_back(r);
+
+        // Clock-free advance: history sampled when the rate is read
+        auto sampled = BenchmarkRunner::run(
+            "Single-thread advance(" + std::to_string(n) + ") [sample-on-read]",
+            n, 1, [n]() {
+                tqdm::tracker_options opts;
+                opts.sample_every = 0;
+                ProgressBarManager bar(n, std::make_unique<tqdm::null_display>(), opts);
+                for (size_t i = 0; i < n; ++i) bar.advance();
+                bar.finish();
+            }
+        );
+        sampled.compare_to(base);
+        out.push_back(sampled);
+
+        // Display fixed at compile time: no render path at all
+        auto fixed = BenchmarkRunner::run(
+            "Single-thread advance(" + std::to_string(n) + ") [static null_display]",
+            n, 1, [n]() {
+                tqdm::tracker_options opts;
+                opts.sample_every = 0;
+                tqdm::progress_bar<size_t, tqdm::null_display> bar(n, opts);
+                for (size_t i = 0; i < n; ++i) bar.advance();
+                bar.finish();
+            }
+        );
+        fixed.compare_to(base);
+        out.push_back(fixed);
     }
 
     // Batch updates: same total updates, fewer calls
@@ -368,27 +927,30 @@ static void benchmark_single_thread() {
         auto r = BenchmarkRunner::run(
             "Batch advance(" + std::to_string(n) + ", batch=" + std::to_string(batch) + ") [tracker-only]",
             n, 1, [n, batch]() {
-                ProgressBarManager bar(n, std::make_unique<null_display>());
+                ProgressBarManager bar(n, std::make_unique<tqdm::null_display>());
                 for (size_t i = 0; i < n; i += batch) bar.advance(batch);
                 bar.finish();
             }
         );
-        r.has_baseline = true;
-        r.baseline_mean_update_s = base.mean_update_s;
-        r.delta_update_s = r.mean_update_s - base.mean_update_s;
+        r.compare_to(base);
         out.push_back(r);
     }
 
-    ResultFormatter::print_header();
-    for (const auto& r : out) ResultFormatter::print_result(r);
+    Report::section("Single-threaded Performance", out);
 }
 
 static void benchmark_multi_thread() {
     using namespace benchmark;
     std::vector<BenchmarkResult> out;
 
+    // Contention sweep: powers of two from 1 up to 2x cores, plus cores and 2x cores
     const size_t cores = std::max(1u, std::thread::hardware_concurrency());
-    std::vector<size_t> thread_counts = {2, 4, cores, cores * 2};
+    std::vector<size_t> thread_counts;
+    for (size_t t = 1; t < cores * 2; t *= 2) thread_counts.push_back(t);
+    thread_counts.push_back(cores);
+    thread_counts.push_back(cores * 2);
+    std::sort(thread_counts.begin(), thread_counts.end());
+    thread_counts.erase(std::unique(thread_counts.begin(), thread_counts.end()), thread_counts.end());
     std::vector<size_t> iters = {10000, 100000, 1000000};
 
     for (auto th : thread_counts) {
@@ -401,7 +963,7 @@ static void benchmark_multi_thread() {
                     std::vector<std::thread> ws;
                     ws.reserve(th);
                     for (size_t t = 0; t < th; ++t) {
-                        ws.emplace_back([per]() { spin_empty_work(per); });
+                        ws.emplace_back([per, t]() { benchmark::pin_thread(t); spin_empty_work(per); });
                     }
                     for (auto& w : ws) w.join();
                 }
@@ -411,11 +973,12 @@ static void benchmark_multi_thread() {
                 "Multi-thread advance(" + std::to_string(n) + ") [tracker-only]",
                 n, th, [n, th]() {
                     size_t per = n / th;
-                    auto bar = std::make_shared<ProgressBarManager>(n, std::make_unique<null_display>());
+                    auto bar = std::make_shared<ProgressBarManager>(n, std::make_unique<tqdm::null_display>());
                     std::vector<std::thread> ws;
                     ws.reserve(th);
                     for (size_t t = 0; t < th; ++t) {
-                        ws.emplace_back([bar, per]() {
+                        ws.emplace_back([bar, per, t]() {
+                            benchmark::pin_thread(t);
                             for (size_t i = 0; i < per; ++i) bar->advance();
                         });
                     }
@@ -423,16 +986,149 @@ static void benchmark_multi_thread() {
                     bar->finish();
                 }
             );
-            r.has_baseline = true;
-            r.baseline_mean_update_s = base.mean_update_s;
-            r.delta_update_s = r.mean_update_s - base.mean_update_s;
+            r.compare_to(base);
             out.push_back(r);
+
+            // Same workload with per-thread counter shards
+            auto s = BenchmarkRunner::run(
+                "Multi-thread advance(" + std::to_string(n) + ") [sharded]",
+                n, th, [n, th]() {
+                    size_t per = n / th;
+                    tqdm::tracker_options opts;
+                    opts.shards = th;
+                    auto bar = std::make_shared<ProgressBarManager>(n, std::make_unique<tqdm::null_display>(), opts);
+                    std::vector<std::thread> ws;
+                    ws.reserve(th);
+                    for (size_t t = 0; t < th; ++t) {
+                        ws.emplace_back([bar, per, t]() {
+                            benchmark::pin_thread(t);
+                            for (size_t i = 0; i < per; ++i) bar->advance();
+                        });
+                    }
+                    for (auto& w : ws) w.join();
+                    bar->finish();
+                }
+            );
+            s.compare_to(base);
+            out.push_back(s);
+        }
+    }
+
+    Report::section("Multi-threaded Performance (tracker-only)", out);
+}
+
+// Per-call advance() latency under mixed work: each thread spins for a
+// random amount between calls and now and then advances in a batch. The
+// display cases are the ones that can hit the render path on the caller;
+// compare a run on a terminal with one redirected to a file.
+static void benchmark_latency() {
+    using namespace benchmark;
+    using clock = std::chrono::steady_clock;
+
+    const size_t cores = std::max(1u, std::thread::hardware_concurrency());
+    const size_t threads = std::max<size_t>(2, cores);
+    const size_t calls = 200000;  // per thread
+    const std::string mode = tqdm::is_tty() ? "tty" : "non-tty";
+    const std::string section = "Tail Latency (stdout: " + mode + ")";
+
+    enum class display_kind { none, standard, jsonl };
+    struct scenario {
+        std::string name;
+        size_t threads;
+        display_kind display;
+        bool background;
+        bool sharded;
+    };
+    const std::string t = std::to_string(threads);
+    const std::vector<scenario> scenarios = {
+        {"advance() latency [null display, 1 thread]", 1, display_kind::none, false, false},
+        {"advance() latency [null display, " + t + " threads, mixed]", threads, display_kind::none, false, false},
+        {"advance() latency [display, 1 thread]", 1, display_kind::standard, false, false},
+        {"advance() latency [display, " + t + " threads, mixed]", threads, display_kind::standard, false, false},
+        {"advance() latency [display+background, " + t + " threads, mixed]", threads, display_kind::standard, true, false},
+        {"advance() latency [sharded+background, " + t + " threads, mixed]", threads, display_kind::standard, true, true},
+        {"advance() latency [jsonl_display, " + t + " threads, mixed]", threads, display_kind::jsonl, false, false},
+    };
+
+    struct row { std::string name; size_t threads; LatencyHistogram hist; };
+    std::vector<row> rows;
+
+    // Cost of the two clock reads around each call, for reference
+    const std::string timer_row = "latency timer overhead (two clock reads)";
+    if (selected(timer_row)) {
+        LatencyHistogram h;
+        for (size_t i = 0; i < calls; ++i) {
+            auto t0 = clock::now();
+            auto t1 = clock::now();
+            h.record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count()));
         }
+        rows.push_back(row{timer_row, 1, h});
     }
 
-    std::cout << "\n\nMulti-threaded Performance (tracker-only):\n";
-    ResultFormatter::print_header();
-    for (const auto& r : out) ResultFormatter::print_result(r);
+    int null_fd = ::open("/dev/null", O_WRONLY);
+    for (const auto& sc : scenarios) {
+        if (!selected(sc.name)) continue;
+
+        tqdm::tracker_options opts;
+        if (sc.sharded) opts.shards = sc.threads;
+        std::unique_ptr<tqdm::display_policy> display;
+        if (sc.display == display_kind::none) display.reset(new tqdm::null_display());
+        if (sc.display == display_kind::jsonl) display.reset(new tqdm::jsonl_display(null_fd));
+        tqdm::progress_bar<> bar(sc.threads * calls * 4, opts, std::move(display));
+        if (sc.background) bar.set_render_mode(tqdm::render_mode::background);
+
+        std::vector<LatencyHistogram> per_thread(sc.threads);
+        std::vector<std::thread> ws;
+        for (size_t w = 0; w < sc.threads; ++w) {
+            ws.emplace_back([&bar, &per_thread, w, calls]() {
+                benchmark::pin_thread(w);
+                std::mt19937 rng(static_cast<unsigned>(1234 + w));
+                std::exponential_distribution<double> work(1.0 / 200.0);  // mean 200 spins
+                std::uniform_int_distribution<int> batch(0, 7);
+                auto& h = per_thread[w];
+                for (size_t i = 0; i < calls; ++i) {
+                    spin_empty_work(static_cast<size_t>(work(rng)));
+                    size_t n = batch(rng) == 0 ? 16 : 1;
+                    auto t0 = clock::now();
+                    bar.advance(n);
+                    auto t1 = clock::now();
+                    h.record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count()));
+                }
+            });
+        }
+        for (auto& w : ws) w.join();
+        bar.finish();
+
+        row r{sc.name, sc.threads, LatencyHistogram()};
+        for (const auto& h : per_thread) r.hist.merge(h);
+        rows.push_back(std::move(r));
+    }
+    if (null_fd >= 0) ::close(null_fd);
+    if (rows.empty()) return;
+
+    std::cout << "\n\n" << section << ":\n\n"
+              << std::setw(60) << std::left << "Benchmark"
+              << std::setw(9) << std::right << "Threads"
+              << std::setw(12) << "Calls"
+              << std::setw(10) << "p50"
+              << std::setw(10) << "p99"
+              << std::setw(10) << "p99.9"
+              << std::setw(10) << "max"
+              << "\n" << std::string(121, '-') << "\n";
+    for (const auto& r : rows) {
+        const double ps[] = {50.0, 99.0, 99.9};
+        const char* labels[] = {"p50", "p99", "p99.9"};
+        std::cout << std::setw(60) << std::left << r.name
+                  << std::setw(9) << std::right << r.threads
+                  << std::setw(12) << r.hist.count();
+        for (int i = 0; i < 3; ++i) {
+            auto v = r.hist.percentile(ps[i]);
+            std::cout << std::setw(10) << format_seconds(static_cast<double>(v) * 1e-9);
+            Report::metric(section, r.name + " " + labels[i], static_cast<double>(v), "ns");
+        }
+        std::cout << std::setw(10) << format_seconds(static_cast<double>(r.hist.max()) * 1e-9) << "\n";
+        Report::metric(section, r.name + " max", static_cast<double>(r.hist.max()), "ns");
+    }
 }
 
 static void benchmark_tracker_vs_display() {
@@ -446,14 +1142,12 @@ static void benchmark_tracker_vs_display() {
     // Tracker-only
     auto tracker_only = BenchmarkRunner::run(
         "Tracker-only (null display)", n, 1, [n]() {
-            ProgressBarManager bar(n, std::make_unique<null_display>());
+            ProgressBarManager bar(n, std::make_unique<tqdm::null_display>());
             for (size_t i = 0; i < n; ++i) bar.advance();
             bar.finish();
         }
     );
-    tracker_only.has_baseline = true;
-    tracker_only.baseline_mean_update_s = base.mean_update_s;
-    tracker_only.delta_update_s = tracker_only.mean_update_s - base.mean_update_s;
+    tracker_only.compare_to(base);
     out.push_back(tracker_only);
 
     // Standard display (TTY-aware; throttled inside)
@@ -467,21 +1161,296 @@ static void benchmark_tracker_vs_display() {
             bar.finish();
         }
     );
-    std_display.has_baseline = true;
-    std_display.baseline_mean_update_s = base.mean_update_s;
-    std_display.delta_update_s = std_display.mean_update_s - base.mean_update_s;
+    std_display.compare_to(base);
     out.push_back(std_display);
 
-    std::cout << "\n\nTracker vs Display:\n";
-    ResultFormatter::print_header();
-    for (const auto& r : out) ResultFormatter::print_result(r);
+    // Rate estimators: ring samples the clock on advance(), ema and window
+    // only on query; eta() is read every 1000 updates
+    const std::pair<const char*, tqdm::rate_estimator> estimators[] = {
+        {"ring", tqdm::rate_estimator::ring},
+        {"ema", tqdm::rate_estimator::ema},
+        {"window", tqdm::rate_estimator::window},
+    };
+    for (const auto& e : estimators) {
+        tqdm::tracker_options options;
+        options.estimator = e.second;
+        auto r = BenchmarkRunner::run(
+            std::string("Tracker advance()+eta() [") + e.first + "]", n, 1, [n, options]() {
+                tqdm::progress_tracker<> tracker(n, options);
+                volatile long long sink = 0;
+                for (size_t i = 0; i < n; ++i) {
+                    tracker.advance();
+                    if (i % 1000 == 0) sink = sink + tracker.eta().count();
+                }
+            }
+        );
+        r.compare_to(base);
+        out.push_back(r);
+    }
+
+    // Terminal capability queries are cached process-wide
+    const size_t queries = 1000000;
+    auto raw_isatty = BenchmarkRunner::run(
+        "isatty() syscall", queries, 1, [queries]() {
+            volatile size_t sink = 0;
+            for (size_t i = 0; i < queries; ++i) sink = sink + (isatty(STDOUT_FILENO) != 0);
+        }
+    );
+    out.push_back(raw_isatty);
+
+    auto cached_isatty = BenchmarkRunner::run(
+        "tqdm::is_tty() [cached]", queries, 1, [queries]() {
+            volatile size_t sink = 0;
+            for (size_t i = 0; i < queries; ++i) sink = sink + tqdm::is_tty();
+        }
+    );
+    out.push_back(cached_isatty);
+
+    // Default display as the process sees it; run with stdout redirected to
+    // measure the non-TTY path
+    auto default_path = BenchmarkRunner::run(
+        std::string("Default display advance() [") + (tqdm::is_tty() ? "tty" : "non-tty") + "]", n, 1, [n]() {
+            ProgressBarManager bar(n);
+            for (size_t i = 0; i < n; ++i) bar.advance();
+            bar.finish();
+        }
+    );
+    default_path.compare_to(base);
+    out.push_back(default_path);
+
+    Report::section("Tracker vs Display", out);
+}
+
+static void benchmark_iteration() {
+    using namespace benchmark;
+    std::vector<BenchmarkResult> out;
+    const size_t n = 1000000;
+    std::vector<size_t> data(n, 1);
+
+    auto base = BenchmarkRunner::run(
+        "Baseline range-for (" + std::to_string(n) + ")", n, 1, [&data]() {
+            volatile size_t sink = 0;
+            for (auto& v : data) sink = sink + v;
+        }
+    );
+    out.push_back(base);
+
+    auto per_element = BenchmarkRunner::run(
+        "tqdm(range) [per-element]", n, 1, [&data]() {
+            volatile size_t sink = 0;
+            for (auto& v : tqdm::tqdm(data)) sink = sink + v;
+        }
+    );
+    per_element.compare_to(base);
+    out.push_back(per_element);
+
+    auto chunked = BenchmarkRunner::run(
+        "tqdm_chunked(range) [adaptive]", n, 1, [&data]() {
+            volatile size_t sink = 0;
+            for (auto& v : tqdm::tqdm_chunked(data)) sink = sink + v;
+        }
+    );
+    chunked.compare_to(base);
+    out.push_back(chunked);
+
+#ifdef TQDM_CPP20
+    // Pipeline stage: the view iterator keeps its own batch count
+    auto piped = BenchmarkRunner::run(
+        "range | views::with_progress", n, 1, [&data]() {
+            volatile size_t sink = 0;
+            for (auto& v : data | tqdm::views::with_progress) sink = sink + v;
+        }
+    );
+    piped.compare_to(base);
+    out.push_back(piped);
+#endif
+
+    // Byte counting through a stream: 16 MiB read in 4 KiB blocks
+    const size_t block = 4096, blocks = 4096;
+    const std::string payload(block * blocks, 'x');
+    auto plain_read = BenchmarkRunner::run(
+        "istream::read (4 KiB blocks)", blocks, 1, [&payload, block]() {
+            std::istringstream in(payload);
+            char buf[4096];
+            while (in.read(buf, block)) {}
+        }
+    );
+    out.push_back(plain_read);
+
+    auto counted_stream = BenchmarkRunner::run(
+        "progress_istream::read (4 KiB blocks)", blocks, 1, [&payload, block]() {
+            std::istringstream in(payload);
+            tqdm::tracker_options options;
+            options.units = tqdm::unit_scale::bytes_binary;
+            tqdm::progress_bar<std::size_t, tqdm::null_display> bar(payload.size(), options);
+            tqdm::progress_istream<decltype(bar)> counted(in, bar);
+            char buf[4096];
+            while (counted.read(buf, block)) {}
+        }
+    );
+    counted_stream.compare_to(plain_read);
+    out.push_back(counted_stream);
+
+    Report::section("Range Iteration", out);
+}
+
+static void benchmark_parallel_for_each() {
+    using namespace benchmark;
+    std::vector<BenchmarkResult> out;
+    const size_t n = 1000000;
+    const size_t cores = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<size_t> data(n, 1);
+    auto work = [](size_t& v) { spin_empty_work(16); v += 1; };
+
+    auto seq = BenchmarkRunner::run(
+        "std::for_each (" + std::to_string(n) + ")", n, 1, [&data, &work]() {
+            std::for_each(data.begin(), data.end(), work);
+        }
+    );
+    out.push_back(seq);
+
+    auto one = BenchmarkRunner::run(
+        "parallel_for_each_with_progress (t=1)", n, 1, [&data, &work]() {
+            tqdm::parallel_for_each_with_progress(data, work, 1);
+        }
+    );
+    one.compare_to(seq);
+    out.push_back(one);
+
+    // Same partitioning without a bar, to isolate the cost of progress
+    auto plain = BenchmarkRunner::run(
+        "Baseline threads (t=" + std::to_string(cores) + ")", n, cores, [&data, &work, cores]() {
+            size_t per = (data.size() + cores - 1) / cores;
+            std::vector<std::thread> ws;
+            ws.reserve(cores);
+            for (size_t t = 0; t < cores; ++t) {
+                size_t lo = std::min(data.size(), t * per), hi = std::min(data.size(), lo + per);
+                ws.emplace_back([&data, &work, lo, hi]() {
+                    std::for_each(data.begin() + lo, data.begin() + hi, work);
+                });
+            }
+            for (auto& w : ws) w.join();
+        }
+    );
+    out.push_back(plain);
+
+    auto many = BenchmarkRunner::run(
+        "parallel_for_each_with_progress (t=" + std::to_string(cores) + ")", n, cores, [&data, &work, cores]() {
+            tqdm::parallel_for_each_with_progress(data, work, cores);
+        }
+    );
+    many.compare_to(plain);
+    out.push_back(many);
+
+    auto stealing = BenchmarkRunner::run(
+        "parallel_for (t=" + std::to_string(cores) + ")", n, cores, [&data, &work, cores]() {
+            tqdm::parallel_for(data, work, cores);
+        }
+    );
+    stealing.compare_to(plain);
+    out.push_back(stealing);
+
+    // Irregular work: the first 1% of items cost 1000x the rest, so a static
+    // split leaves every worker but the first idle for most of the run
+    const size_t m = 100000;
+    std::vector<size_t> skewed(m, 1);
+    auto skewed_work = [m](size_t i) { spin_empty_work(i < m / 100 ? 16000 : 16); };
+
+    auto flat = BenchmarkRunner::run(
+        "Irregular, chunked pool (t=" + std::to_string(cores) + ")", m, cores, [&skewed, &skewed_work, cores]() {
+            tqdm::parallel_for_each_with_progress(skewed, [&skewed, &skewed_work](size_t& v) {
+                skewed_work(static_cast<size_t>(&v - skewed.data()));
+            }, cores);
+        }
+    );
+    out.push_back(flat);
+
+    auto stolen = BenchmarkRunner::run(
+        "Irregular, parallel_for (t=" + std::to_string(cores) + ")", m, cores, [&skewed_work, m, cores]() {
+            tqdm::parallel_for(size_t(0), m, skewed_work, cores);
+        }
+    );
+    stolen.compare_to(flat);
+    out.push_back(stolen);
+
+    Report::section("Parallel for_each", out);
+}
+
+static void benchmark_render_path() {
+    using namespace benchmark;
+    std::vector<BenchmarkResult> out;
+    const size_t frames = 10000;
+
+    tqdm::progress_tracker<> tracker(frames);
+    tqdm::bar_display<> display;
+    display.set_label("Render");
+
+    auto r = BenchmarkRunner::run(
+        "Compose frame (" + std::to_string(frames) + ")", frames, 1, [&tracker, &display, frames]() {
+            for (size_t i = 0; i < frames; ++i) {
+                tracker.advance();
+                display.compose(tracker);
+            }
+        }
+    );
+    out.push_back(r);
+
+    // Group roll-up: the parent frame costs the same however many tasks feed it
+    for (size_t tasks : {size_t(10), size_t(10000)}) {
+        tqdm::progress_group group(tasks);
+        std::vector<tqdm::progress_group::task> children;
+        children.reserve(tasks);
+        for (size_t i = 0; i < tasks; ++i) children.push_back(group.add_task(100));
+        auto g = BenchmarkRunner::run(
+            "Compose group parent (" + std::to_string(tasks) + " tasks)", frames, 1,
+            [&group, &children, &display, frames]() {
+                for (size_t i = 0; i < frames; ++i) {
+                    children[i % children.size()].advance();
+                    display.compose(group.parent());
+                }
+            }
+        );
+        out.push_back(g);
+    }
+
+    Report::section("Render Path", out);
+
+    if (benchmark::selected("Allocations per frame")) {
+        size_t before = AllocationCounter::now();
+        for (size_t i = 0; i < frames; ++i) display.compose(tracker);
+        double per_frame = static_cast<double>(AllocationCounter::now() - before) / static_cast<double>(frames);
+        std::cout << "Allocations per frame: " << std::fixed << std::setprecision(3) << per_frame << "\n";
+        Report::metric("Render Path", "Allocations per frame", per_frame, "allocs");
+    }
+    if (!benchmark::selected("Bytes per frame")) return;
+
+    // Bytes the incremental renderer would emit for a steadily advancing bar
+    tqdm::progress_tracker<> inc_tracker(frames);
+    tqdm::frame_differ differ;
+    differ.reserve(display.compose(inc_tracker).capacity());
+    size_t full_bytes = 0, diff_bytes = 0, skipped = 0;
+    for (size_t i = 0; i < frames; ++i) {
+        inc_tracker.advance();
+        auto& frame = display.compose(inc_tracker);
+        full_bytes += frame.size() + 1;
+        auto& update = differ.diff(frame);
+        diff_bytes += update.size();
+        if (update.size() == 0) ++skipped;
+    }
+    double full_per_frame = static_cast<double>(full_bytes) / static_cast<double>(frames);
+    double diff_per_frame = static_cast<double>(diff_bytes) / static_cast<double>(frames);
+    std::cout << "Bytes per frame: full " << std::fixed << std::setprecision(1) << full_per_frame
+              << ", incremental " << diff_per_frame
+              << " (" << skipped << " of " << frames << " writes skipped)\n";
+    Report::metric("Render Path", "Bytes per frame (full)", full_per_frame, "bytes");
+    Report::metric("Render Path", "Bytes per frame (incremental)", diff_per_frame, "bytes");
 }
 
 static void benchmark_memory_usage() {
     using namespace benchmark;
     std::vector<BenchmarkResult> out;
 
-    std::vector<size_t> counts = {1, 10, 100, 1000};
+    std::vector<size_t> counts = {1, 10, 100, 1000, 10000};
     for (auto c : counts) {
         auto r = BenchmarkRunner::run(
             "Memory usage (" + std::to_string(c) + " bars)",
@@ -489,7 +1458,7 @@ static void benchmark_memory_usage() {
                 std::vector<std::shared_ptr<ProgressBarManager>> bars;
                 bars.reserve(c);
                 for (size_t i = 0; i < c; ++i) {
-                    bars.push_back(std::make_shared<ProgressBarManager>(1000, std::make_unique<null_display>()));
+                    bars.push_back(std::make_shared<ProgressBarManager>(1000, std::make_unique<tqdm::null_display>()));
                 }
                 for (size_t i = 0; i < 1000; ++i) {
                     for (auto& b : bars) b->advance();
@@ -500,22 +1469,139 @@ static void benchmark_memory_usage() {
         out.push_back(r);
     }
 
-    std::cout << "\n\nMemory Usage:\n";
-    ResultFormatter::print_header();
-    for (const auto& r : out) ResultFormatter::print_result(r);
+    // Pooled compact trackers, the per-file case
+    std::vector<size_t> pooled_counts = {1000, 10000, 100000};
+    for (auto c : pooled_counts) {
+        auto r = BenchmarkRunner::run(
+            "Pooled compact trackers (" + std::to_string(c) + ")",
+            c * 10, 1, [c]() {
+                tqdm::tracker_pool pool(c);
+                std::vector<tqdm::compact_tracker*> trackers(c);
+                for (auto& t : trackers) t = pool.acquire(10);
+                for (size_t i = 0; i < 10; ++i) {
+                    for (auto* t : trackers) t->advance();
+                }
+                for (auto* t : trackers) pool.release(t);
+            }
+        );
+        out.push_back(r);
+    }
+
+    Report::section("Memory Usage", out);
+
+    // Heap cost of creating one bar, averaged over many
+    auto per_item = [](const std::string& what, size_t items, size_t calls, size_t bytes) {
+        double mallocs = static_cast<double>(calls) / static_cast<double>(items);
+        double per = static_cast<double>(bytes) / static_cast<double>(items);
+        std::cout << std::setw(44) << std::left << (what + ":") << std::right
+                  << std::fixed << std::setprecision(2) << mallocs << " mallocs, " << per << " bytes\n";
+        Report::metric("Memory Usage", what + " mallocs", mallocs, "allocs");
+        Report::metric("Memory Usage", what + " bytes", per, "bytes");
+    };
+
+    // Compact multi_progress lines: shared display, pooled tracker and label
+    if (benchmark::selected("Per line")) {
+        const size_t lines = 100000;
+        size_t calls = AllocationCounter::now(), bytes = AllocationCounter::bytes_now();
+        std::unique_ptr<tqdm::multi_progress> block(new tqdm::multi_progress());
+        for (size_t i = 0; i < lines; ++i) block->add_compact(1000, "file " + std::to_string(i));
+        per_item("Per line, multi_progress::add_compact()", lines,
+                 AllocationCounter::now() - calls, AllocationCounter::bytes_now() - bytes);
+#ifdef __linux__
+        // The final redraw of the block is not part of the measurement.
+        std::cout.flush();
+        int saved = ::dup(STDOUT_FILENO);
+        int null_fd = ::open("/dev/null", O_WRONLY);
+        ::dup2(null_fd, STDOUT_FILENO);
+        block.reset();
+        ::dup2(saved, STDOUT_FILENO);
+        ::close(null_fd);
+        ::close(saved);
+#endif
+    }
+
+    if (!benchmark::selected("Per bar")) return;
+    const size_t bars = 10000;
+    auto per_bar = [bars, &per_item](const std::string& what, size_t calls, size_t bytes) {
+        per_item("Per bar, " + what, bars, calls, bytes);
+    };
+    {
+        std::vector<std::unique_ptr<tqdm::progress_bar<>>> full;
+        full.reserve(bars);
+        size_t calls = AllocationCounter::now(), bytes = AllocationCounter::bytes_now();
+        for (size_t i = 0; i < bars; ++i) {
+            full.emplace_back(new tqdm::progress_bar<>(1000, std::unique_ptr<tqdm::display_policy>(new tqdm::null_display())));
+        }
+        per_bar("progress_bar<>", AllocationCounter::now() - calls, AllocationCounter::bytes_now() - bytes);
+    }
+    {
+        size_t calls = AllocationCounter::now(), bytes = AllocationCounter::bytes_now();
+        tqdm::tracker_pool pool(bars);
+        per_bar("tracker_pool (reserve)", AllocationCounter::now() - calls, AllocationCounter::bytes_now() - bytes);
+
+        std::vector<tqdm::compact_tracker*> trackers;
+        trackers.reserve(bars);
+        calls = AllocationCounter::now();
+        bytes = AllocationCounter::bytes_now();
+        for (size_t i = 0; i < bars; ++i) trackers.push_back(pool.acquire(1000));
+        per_bar("tracker_pool::acquire()", AllocationCounter::now() - calls, AllocationCounter::bytes_now() - bytes);
+        for (auto* t : trackers) pool.release(t);
+    }
 }
 
-int main(int, char*[]) {
+static void print_usage(const char* argv0) {
+    std::cout << "usage: " << argv0 << " [options]\n"
+              << "  --filter=TEXT      run only benchmarks whose name contains TEXT\n"
+              << "  --json=FILE        write results as JSON\n"
+              << "  --csv=FILE         write results as CSV (the baseline format)\n"
+              << "  --baseline=FILE    compare with a CSV from an earlier run; exit 1 on regression\n"
+              << "  --threshold=PCT    slowdown counted as a regression (default 10)\n"
+              << "  --min-time=SEC     sampling time per benchmark (default 1)\n"
+              << "  --pin              pin benchmark threads to CPUs\n";
+}
+
+static bool parse_args(int argc, char* argv[]) {
+    auto& o = benchmark::options();
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value = [&arg](const char* flag) -> const char* {
+            size_t n = std::strlen(flag);
+            return arg.compare(0, n, flag) == 0 ? arg.c_str() + n : nullptr;
+        };
+        if (auto v = value("--filter=")) o.filter = v;
+        else if (auto v = value("--json=")) o.json_path = v;
+        else if (auto v = value("--csv=")) o.csv_path = v;
+        else if (auto v = value("--baseline=")) o.baseline_path = v;
+        else if (auto v = value("--threshold=")) o.threshold_pct = std::atof(v);
+        else if (auto v = value("--min-time=")) o.min_time_s = std::atof(v);
+        else if (arg == "--pin") o.pin = true;
+        else {
+            print_usage(argv[0]);
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    if (!parse_args(argc, argv)) return 2;
+
     std::cout << "tqdm C++ Benchmark Suite\n";
     std::cout << "========================\n\n";
     print_system_info();
+    benchmark::pin_thread(0);
 
     std::cout << "Starting benchmarks...\n";
     benchmark_single_thread();
     benchmark_multi_thread();
+    benchmark_latency();
     benchmark_tracker_vs_display();
+    benchmark_iteration();
+    benchmark_parallel_for_each();
+    benchmark_render_path();
     benchmark_memory_usage();
 
+    int status = Report::finish();
     std::cout << "\nBenchmark complete!\n";
-    return 0;
+    return status;
 }
@@ -95,5 +95,15 @@ for std in c++11 c++14 c++17 c++20; do
   fi
 done
 
+log "\n=== Tail latency: stdout on a pty vs redirected to a file ==="
+run_sh_logged "make clean >/dev/null 2>&1 && make >/dev/null 2>&1"
+log "\n-- stdout: pty --"
+# No pipe here: the benchmark's stdout must be the pty itself
+run_sh_logged "./tqdm_benchmark --filter=latency" || true
+log "\n-- stdout: file --"
+LATENCY_FILE="logs/latency_file_${TS}.txt"
+./tqdm_benchmark --filter=latency >"$LATENCY_FILE" 2>&1 || true
+sed -n '/Tail Latency/,$p' "$LATENCY_FILE" | tee -a "$RAW_LOG"
+
 log "\nBenchmark complete!"
 log "Log: $RAW_LOG"
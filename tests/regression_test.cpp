@@ -0,0 +1,56 @@
+// regression_test.cpp
+// Checks for bugs that were fixed once and must stay fixed. Each check
+// prints its name and the program exits 1 on the first failure.
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "../tqdm.h"
+
+#define CHECK(cond)                                                                   \
+    do {                                                                              \
+        if (!(cond)) {                                                                \
+            std::fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            std::exit(1);                                                             \
+        }                                                                             \
+    } while (0)
+
+using quiet_bar = tqdm::progress_bar<std::size_t, tqdm::null_display>;
+
+// Zero-cost items must not be credited as unit weight once their batch
+// reaches the bar.
+static void weighted_zero_cost_items() {
+    quiet_bar bar(1001);
+    bar.set_total_weight(1000);
+    tqdm::chunked_advancer<quiet_bar> batch(&bar, 0);
+    for (int i = 0; i < 1000; ++i) batch.advance_weighted(0);
+    batch.flush();
+    CHECK(bar.current() == 1000);
+    CHECK(bar.percentage() == 0.0);
+
+    batch.advance_weighted(1000);
+    batch.flush();
+    CHECK(bar.percentage() == 100.0);
+}
+
+// A plain advance() on a weighted bar counts as unit weight.
+static void weighted_plain_advance() {
+    quiet_bar bar(4);
+    bar.set_total_weight(4);
+    bar.advance(1, 2);
+    bar.advance(2);
+    CHECK(bar.percentage() == 100.0);
+}
+
+int main() {
+    struct test { const char* name; void (*run)(); };
+    const test tests[] = {
+        {"weighted_zero_cost_items", weighted_zero_cost_items},
+        {"weighted_plain_advance", weighted_plain_advance},
+    };
+    for (const auto& t : tests) {
+        t.run();
+        std::printf("ok  %s\n", t.name);
+    }
+    return 0;
+}
@@ -0,0 +1,117 @@
+// tqdm_monitor.cpp - watch progress exported through a shared-memory segment
+//
+// usage: tqdm_monitor <segment-name> [interval-ms]
+//
+// The job creates the segment with tqdm::shared_progress_segment::create()
+// and counts into its slots; this tool maps it read-only and redraws one line
+// per slot. Rates come from the difference between consecutive snapshots.
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <cstdlib>
+
+#include "../tqdm.h"
+
+namespace {
+
+struct snapshot {
+    std::size_t current{0};
+    std::chrono::steady_clock::time_point when{};
+    double rate{0.0};
+};
+
+std::chrono::milliseconds since_unix_ns(std::int64_t start_ns) {
+    auto now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    return std::chrono::milliseconds((now - start_ns) / 1000000);
+}
+
+void compose_line(tqdm::frame_buffer& out, const tqdm::shm_slot& slot, const snapshot& snap) {
+    auto total = slot.total.load(std::memory_order_relaxed);
+    auto state = slot.state.load(std::memory_order_acquire);
+
+    out.append(slot.label, strnlen(slot.label, sizeof(slot.label)));
+    out.append(": ");
+    if (total) {
+        double pct = std::min(100.0, 100.0 * static_cast<double>(snap.current) / static_cast<double>(total));
+        out.append_fixed1(pct);
+        out.append("% ");
+    }
+    out.append_uint(snap.current);
+    if (total) {
+        out.append('/');
+        out.append_uint(total);
+    }
+    out.append(" [");
+    tqdm::append_rate(out, snap.rate);
+    out.append(", ");
+    tqdm::append_time(out, since_unix_ns(slot.start_unix_ns.load(std::memory_order_relaxed)));
+    if (state == tqdm::shm_slot::finished) {
+        out.append(", done");
+    } else if (total && snap.rate > 0 && snap.current < total) {
+        out.append(", ETA ");
+        tqdm::append_time(out, std::chrono::milliseconds(
+            static_cast<long long>(1000.0 * static_cast<double>(total - snap.current) / snap.rate)));
+    }
+    out.append("]\033[K\n");
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "usage: " << argv[0] << " <segment-name> [interval-ms]\n";
+        return 2;
+    }
+    auto interval = std::chrono::milliseconds(argc > 2 ? std::atoi(argv[2]) : 250);
+    if (interval.count() <= 0) interval = std::chrono::milliseconds(250);
+
+    auto segment = tqdm::shared_progress_segment::open(argv[1]);
+    if (!segment) {
+        std::cerr << "cannot open progress segment " << argv[1] << "\n";
+        return 1;
+    }
+
+    std::vector<snapshot> snaps(segment.slot_count());
+    tqdm::frame_buffer frame(128 + snaps.size() * 160);
+    std::size_t drawn = 0;
+
+    for (;;) {
+        frame.clear();
+        if (drawn) {
+            frame.append("\033[");
+            frame.append_uint(drawn);
+            frame.append('A');
+        }
+
+        std::size_t lines = 0;
+        bool any_running = false;
+        auto now = std::chrono::steady_clock::now();
+        for (std::size_t i = 0; i < snaps.size(); ++i) {
+            const auto* slot = segment.slot(i);
+            auto state = slot->state.load(std::memory_order_acquire);
+            if (state == tqdm::shm_slot::free_slot) continue;
+            any_running = any_running || state == tqdm::shm_slot::running;
+
+            auto& snap = snaps[i];
+            auto current = slot->current.load(std::memory_order_relaxed);
+            if (snap.when != std::chrono::steady_clock::time_point{}) {
+                auto dt = std::chrono::duration<double>(now - snap.when).count();
+                if (dt > 0 && current >= snap.current)
+                    snap.rate = static_cast<double>(current - snap.current) / dt;
+            }
+            snap.current = current;
+            snap.when = now;
+
+            compose_line(frame, *slot, snap);
+            ++lines;
+        }
+        tqdm::detail::write_all(STDOUT_FILENO, frame.data(), frame.size());
+        drawn = lines;
+
+        if (lines && !any_running) break;
+        std::this_thread::sleep_for(interval);
+    }
+    return 0;
+}
@@ -31,27 +31,57 @@
 #include <type_traits>
 #include <cstring>
 #include <limits>
+#include <cstdint>
+#include <cerrno>
+#include <exception>
+#include <condition_variable>
+#include <functional>
+#include <utility>
+#include <fstream>
+#include <new>
+#include <cstdio>
+#include <cstdlib>
 
 #ifdef TQDM_CPP17
 #  include <optional>
 #  include <string_view>
-#  include <shared_mutex>
+#endif
+
+// The execution-policy overloads are opt-in: with libstdc++, <execution>
+// needs TBB at link time. Include <execution> before tqdm.h, or define
+// TQDM_ENABLE_EXECUTION to have it included here.
+#if __cplusplus >= 201703L
+#  if defined(TQDM_ENABLE_EXECUTION) && __has_include(<execution>)
+#    include <execution>
+#  endif
+#  ifdef __cpp_lib_execution
+#    include <execution>
+#    define TQDM_HAS_EXECUTION
+#  endif
 #endif
 
 #ifdef TQDM_CPP20
 #  include <concepts>
 #  include <ranges>
 #  include <span>
+#  if __has_include(<coroutine>) && defined(__cpp_impl_coroutine)
+#    include <coroutine>
+#    define TQDM_HAS_COROUTINES
+#  endif
 #endif
 
 // Unix-specific headers
 #include <unistd.h>
+#include <signal.h>
+#include <fcntl.h>
 #include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 namespace tqdm {
 
 // Forward declarations
-template<typename T> class progress_bar;
+template<typename T, typename DisplayT> class progress_bar;
 template<typename ContainerT> class progress_range;
 
 // =============================================================================
@@ -91,46 +121,312 @@ using rate_hz_t = strong_type<double, struct rate_tag>;
 // Utility Functions
 // =============================================================================
 
-inline int get_terminal_width() {
-    struct winsize w;
-    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &w) == 0) return w.ws_col;
-    return 80; // Default fallback
+namespace detail {
+// Process-wide terminal capabilities, detected on first use. The width is
+// re-read only after a SIGWINCH (define TQDM_NO_SIGWINCH to leave the signal
+// alone; the width is then read once).
+struct terminal_info {
+    std::atomic<int> tty{-1};  // -1 = not detected yet
+    std::atomic<int> width{80};
+    std::atomic<bool> width_stale{true};
+};
+
+inline terminal_info& terminal() {
+    static terminal_info info;
+    return info;
+}
+
+#ifndef TQDM_NO_SIGWINCH
+inline struct sigaction& previous_winch_action() {
+    static struct sigaction action;
+    return action;
+}
+
+inline void on_sigwinch(int sig, siginfo_t* info, void* context) {
+    terminal().width_stale.store(true, std::memory_order_relaxed);
+    auto& prev = previous_winch_action();
+    if (prev.sa_flags & SA_SIGINFO) {
+        if (prev.sa_sigaction) prev.sa_sigaction(sig, info, context);
+    } else if (prev.sa_handler != SIG_DFL && prev.sa_handler != SIG_IGN) {
+        prev.sa_handler(sig);
+    }
+}
+
+inline bool install_winch_handler() {
+    terminal();
+    struct sigaction action;
+    std::memset(&action, 0, sizeof(action));
+    action.sa_sigaction = on_sigwinch;
+    action.sa_flags = SA_SIGINFO | SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    return sigaction(SIGWINCH, &action, &previous_winch_action()) == 0;
 }
+#endif
+} // namespace detail
 
 inline bool is_tty() {
-    return isatty(STDOUT_FILENO) != 0;
+    auto& term = detail::terminal();
+    auto tty = term.tty.load(std::memory_order_relaxed);
+    if (tty < 0) {
+        tty = isatty(STDOUT_FILENO) != 0 ? 1 : 0;
+        term.tty.store(tty, std::memory_order_relaxed);
+    }
+    return tty != 0;
 }
 
-inline std::string format_time(std::chrono::milliseconds ms) {
+inline int get_terminal_width() {
+    auto& term = detail::terminal();
+    if (term.width_stale.load(std::memory_order_relaxed) &&
+        term.width_stale.exchange(false, std::memory_order_relaxed)) {
+#ifndef TQDM_NO_SIGWINCH
+        static bool handler_installed = is_tty() && detail::install_winch_handler();
+        (void)handler_installed;
+#endif
+        struct winsize w;
+        int width = 80; // Default fallback
+        if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &w) == 0 && w.ws_col > 0) width = w.ws_col;
+        term.width.store(width, std::memory_order_relaxed);
+    }
+    return term.width.load(std::memory_order_relaxed);
+}
+
+// Forget the cached terminal state, e.g. after stdout has been redirected.
+inline void refresh_terminal_state() {
+    auto& term = detail::terminal();
+    term.tty.store(-1, std::memory_order_relaxed);
+    term.width_stale.store(true, std::memory_order_relaxed);
+}
+
+namespace detail {
+// Small per-thread index used to pick a counter shard. Threads are numbered
+// in the order they first touch a sharded tracker.
+inline std::size_t thread_slot() noexcept {
+    static std::atomic<std::size_t> next_slot{0};
+    thread_local std::size_t slot = next_slot.fetch_add(1, std::memory_order_relaxed);
+    return slot;
+}
+
+// write(2) the whole buffer, retrying on short writes and EINTR.
+inline void write_all(int fd, const char* data, std::size_t size) noexcept {
+    while (size > 0) {
+        auto written = ::write(fd, data, size);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return;
+        }
+        data += written;
+        size -= static_cast<std::size_t>(written);
+    }
+}
+
+inline std::size_t round_up_pow2(std::size_t n) noexcept {
+    std::size_t p = 1;
+    while (p < n) p <<= 1;
+    return p;
+}
+
+// Heap array that honours alignof(T) in every language mode. Before C++17
+// new[] ignores extended alignment, which would let cache-line-aligned
+// per-thread slots share lines again.
+template<typename T>
+class aligned_array {
+    T* data_{nullptr};
+    std::size_t size_{0};
+
+public:
+    aligned_array() = default;
+    explicit aligned_array(std::size_t n) { reset(n); }
+    ~aligned_array() { reset(0); }
+
+    aligned_array(const aligned_array&) = delete;
+    aligned_array& operator=(const aligned_array&) = delete;
+
+    void reset(std::size_t n) {
+        for (std::size_t i = size_; i > 0; --i) data_[i - 1].~T();
+        std::free(data_);
+        data_ = nullptr;
+        size_ = 0;
+        if (n == 0) return;
+        void* raw = nullptr;
+        auto alignment = std::max(alignof(T), sizeof(void*));
+        if (::posix_memalign(&raw, alignment, n * sizeof(T)) != 0) throw std::bad_alloc();
+        data_ = static_cast<T*>(raw);
+        for (; size_ < n; ++size_) new (data_ + size_) T();
+    }
+
+    T& operator[](std::size_t i) noexcept { return data_[i]; }
+    const T& operator[](std::size_t i) const noexcept { return data_[i]; }
+    std::size_t size() const noexcept { return size_; }
+    explicit operator bool() const noexcept { return data_ != nullptr; }
+};
+
+// Single over-aligned object on the heap, e.g. a progress_tracker, for the
+// same reason: before C++17 a plain new would not honour alignof(T).
+template<typename T>
+struct aligned_delete {
+    void operator()(T* p) const noexcept {
+        if (!p) return;
+        p->~T();
+        std::free(p);
+    }
+};
+
+template<typename T>
+using aligned_ptr = std::unique_ptr<T, aligned_delete<T>>;
+
+template<typename T, typename... Args>
+aligned_ptr<T> make_aligned(Args&&... args) {
+    void* raw = nullptr;
+    auto alignment = std::max(alignof(T), sizeof(void*));
+    if (::posix_memalign(&raw, alignment, sizeof(T)) != 0) throw std::bad_alloc();
+    try {
+        return aligned_ptr<T>(new (raw) T(std::forward<Args>(args)...));
+    } catch (...) {
+        std::free(raw);
+        throw;
+    }
+}
+} // namespace detail
+
+// Fixed-capacity character buffer used to build a frame without touching the
+// heap. Storage is allocated by reserve() only; appends past the capacity are
+// truncated rather than reallocating.
+class frame_buffer {
+    std::unique_ptr<char[]> data_;
+    std::size_t capacity_{0};
+    std::size_t size_{0};
+
+public:
+    frame_buffer() = default;
+    explicit frame_buffer(std::size_t capacity) { reserve(capacity); }
+
+    void reserve(std::size_t capacity) {
+        if (capacity <= capacity_) return;
+        std::unique_ptr<char[]> grown(new char[capacity]);
+        if (size_) std::memcpy(grown.get(), data_.get(), size_);
+        data_ = std::move(grown);
+        capacity_ = capacity;
+    }
+
+    void clear() noexcept { size_ = 0; }
+    void resize(std::size_t n) noexcept { size_ = std::min(n, capacity_); }
+    const char* data() const noexcept { return data_.get(); }
+    std::size_t size() const noexcept { return size_; }
+    std::size_t capacity() const noexcept { return capacity_; }
+
+    void append(const char* s, std::size_t n) noexcept {
+        n = std::min(n, capacity_ - size_);
+        if (n) std::memcpy(data_.get() + size_, s, n);
+        size_ += n;
+    }
+    void append(const char* s) noexcept { append(s, std::strlen(s)); }
+    void append(const std::string& s) noexcept { append(s.data(), s.size()); }
+    void append(char c) noexcept { if (size_ < capacity_) data_[size_++] = c; }
+    void append(std::size_t count, char c) noexcept {
+        count = std::min(count, capacity_ - size_);
+        if (count) std::memset(data_.get() + size_, c, count);
+        size_ += count;
+    }
+
+    void append_uint(unsigned long long v, std::size_t min_width = 0) noexcept {
+        char digits[24];
+        std::size_t n = 0;
+        do {
+            digits[n++] = static_cast<char>('0' + v % 10);
+            v /= 10;
+        } while (v);
+        if (min_width > n) append(min_width - n, ' ');
+        while (n) append(digits[--n]);
+    }
+
+    // Fixed-point with one decimal, rounded like std::fixed/setprecision(1).
+    void append_fixed1(double v) noexcept {
+        if (!(v > 0)) v = 0;
+        if (v > 1e17) v = 1e17;
+        auto tenths = static_cast<unsigned long long>(std::nearbyint(v * 10.0));
+        append_uint(tenths / 10);
+        append('.');
+        append(static_cast<char>('0' + tenths % 10));
+    }
+};
+
+inline void append_time(frame_buffer& out, std::chrono::milliseconds ms) noexcept {
     auto seconds = std::chrono::duration_cast<std::chrono::seconds>(ms).count();
+    if (seconds < 0) seconds = 0;
     auto minutes = seconds / 60;
     auto hours = minutes / 60;
 
-    std::ostringstream oss;
     if (hours > 0) {
-        oss << hours << "h" << (minutes % 60) << "m";
+        out.append_uint(static_cast<unsigned long long>(hours)); out.append('h');
+        out.append_uint(static_cast<unsigned long long>(minutes % 60)); out.append('m');
     } else if (minutes > 0) {
-        oss << minutes << "m" << (seconds % 60) << "s";
+        out.append_uint(static_cast<unsigned long long>(minutes)); out.append('m');
+        out.append_uint(static_cast<unsigned long long>(seconds % 60)); out.append('s');
     } else {
-        oss << seconds << "s";
+        out.append_uint(static_cast<unsigned long long>(seconds)); out.append('s');
     }
-    return oss.str();
 }
 
-inline std::string format_rate(double rate) {
-    std::ostringstream oss;
-    oss << std::fixed << std::setprecision(1);
-
+inline void append_rate(frame_buffer& out, double rate) noexcept {
     if (rate >= 1e9) {
-        oss << rate / 1e9 << " G/s";
+        out.append_fixed1(rate / 1e9); out.append(" G/s");
     } else if (rate >= 1e6) {
-        oss << rate / 1e6 << " M/s";
+        out.append_fixed1(rate / 1e6); out.append(" M/s");
     } else if (rate >= 1e3) {
-        oss << rate / 1e3 << " K/s";
+        out.append_fixed1(rate / 1e3); out.append(" K/s");
+    } else {
+        out.append_fixed1(rate); out.append(" /s");
+    }
+}
+
+// How a tracker's counts are printed. The byte modes scale by 1000 (kB, MB)
+// or by 1024 (KiB, MiB).
+enum class unit_scale { items, bytes_decimal, bytes_binary };
+
+inline void append_bytes(frame_buffer& out, double bytes, unit_scale units) noexcept {
+    static const char* const decimal[] = {" B", " kB", " MB", " GB", " TB", " PB"};
+    static const char* const binary[] = {" B", " KiB", " MiB", " GiB", " TiB", " PiB"};
+    const bool is_binary = units == unit_scale::bytes_binary;
+    const double base = is_binary ? 1024.0 : 1000.0;
+    std::size_t prefix = 0;
+    if (!(bytes > 0)) bytes = 0;
+    while (bytes >= base && prefix < 5) {
+        bytes /= base;
+        ++prefix;
+    }
+    if (prefix == 0) {
+        out.append_uint(static_cast<unsigned long long>(bytes));
     } else {
-        oss << rate << " /s";
+        out.append_fixed1(bytes);
+    }
+    out.append(is_binary ? binary[prefix] : decimal[prefix]);
+}
+
+inline void append_rate(frame_buffer& out, double rate, unit_scale units) noexcept {
+    if (units == unit_scale::items) {
+        append_rate(out, rate);
+        return;
     }
-    return oss.str();
+    append_bytes(out, rate, units);
+    out.append("/s");
+}
+
+inline std::string format_time(std::chrono::milliseconds ms) {
+    frame_buffer buf(32);
+    append_time(buf, ms);
+    return std::string(buf.data(), buf.size());
+}
+
+inline std::string format_rate(double rate) {
+    frame_buffer buf(32);
+    append_rate(buf, rate);
+    return std::string(buf.data(), buf.size());
+}
+
+inline std::string format_bytes(double bytes, unit_scale units = unit_scale::bytes_binary) {
+    frame_buffer buf(32);
+    append_bytes(buf, bytes, units);
+    return std::string(buf.data(), buf.size());
 }
 
 // =============================================================================
@@ -159,6 +455,117 @@ inline rgb hsv_to_rgb(double h, double s, double v) {
     return {0, 0, 0};
 }
 
+// Colour escape styles, from most to least capable terminal.
+enum class color_mode { none, ansi16, ansi256, truecolor };
+
+// Guess what stdout's terminal understands from the usual environment
+// conventions: NO_COLOR disables colour, COLORTERM=truecolor|24bit enables
+// 24-bit colour, a TERM ending in 256color gets the 256-colour palette and
+// anything else but dumb gets the 16 basic colours.
+inline color_mode detect_color_mode() {
+    if (!is_tty()) return color_mode::none;
+    const char* no_color = std::getenv("NO_COLOR");
+    if (no_color && *no_color) return color_mode::none;
+    const char* colorterm = std::getenv("COLORTERM");
+    if (colorterm && (std::strcmp(colorterm, "truecolor") == 0 || std::strcmp(colorterm, "24bit") == 0)) {
+        return color_mode::truecolor;
+    }
+    const char* term = std::getenv("TERM");
+    if (!term || !*term || std::strcmp(term, "dumb") == 0) return color_mode::none;
+    if (std::strstr(term, "256color")) return color_mode::ansi256;
+    return color_mode::ansi16;
+}
+
+// Ready-made foreground escapes for every integer percentage, so colouring a
+// frame is a lookup and a copy. The hue runs from hue_from at 0% to hue_to at
+// 100%; each escape is quantised to what the colour mode can show.
+class color_gradient {
+public:
+    static constexpr std::size_t STEPS = 101;
+    static constexpr std::size_t MAX_ESCAPE = 20;  // "\033[38;2;255;255;255m"
+
+    color_gradient(color_mode mode, double hue_from, double hue_to)
+        : mode_(mode), hue_from_(hue_from), hue_to_(hue_to) {
+        for (std::size_t i = 0; i < STEPS; ++i) {
+            double hue = hue_from + (hue_to - hue_from) * static_cast<double>(i) / 100.0;
+            hue -= std::floor(hue);
+            auto color = hsv_to_rgb(hue, 0.8, 1.0);
+            auto& e = escapes_[i];
+            int n = 0;
+            switch (mode) {
+                case color_mode::truecolor:
+                    n = std::snprintf(e.text, MAX_ESCAPE, "\033[38;2;%d;%d;%dm", color.r, color.g, color.b);
+                    break;
+                case color_mode::ansi256:
+                    n = std::snprintf(e.text, MAX_ESCAPE, "\033[38;5;%dm", cube_index(color));
+                    break;
+                case color_mode::ansi16:
+                    n = std::snprintf(e.text, MAX_ESCAPE, "\033[%dm", basic_index(color));
+                    break;
+                case color_mode::none:
+                    break;
+            }
+            e.size = static_cast<unsigned char>(n > 0 ? n : 0);
+        }
+    }
+
+    color_mode mode() const noexcept { return mode_; }
+
+    void append(frame_buffer& out, double percentage) const noexcept {
+        if (!(percentage > 0.0)) percentage = 0.0;
+        auto i = std::min(static_cast<std::size_t>(std::nearbyint(percentage)), STEPS - 1);
+        out.append(escapes_[i].text, escapes_[i].size);
+    }
+
+    // Tables are immutable and shared by every display that asks for the same
+    // mode and hue range; they live for the rest of the process.
+    static const color_gradient& shared(color_mode mode, double hue_from, double hue_to) {
+        static std::mutex mutex;
+        static std::vector<std::unique_ptr<color_gradient>> tables;
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto& t : tables) {
+            if (t->mode_ == mode && t->hue_from_ == hue_from && t->hue_to_ == hue_to) return *t;
+        }
+        tables.emplace_back(new color_gradient(mode, hue_from, hue_to));
+        return *tables.back();
+    }
+
+private:
+    struct escape {
+        char text[MAX_ESCAPE];
+        unsigned char size;
+    };
+
+    color_mode mode_;
+    double hue_from_;
+    double hue_to_;
+    std::array<escape, STEPS> escapes_;
+
+    // Nearest entry of the xterm 6x6x6 colour cube.
+    static int cube_index(rgb c) {
+        auto level = [](int v) { return v < 48 ? 0 : v < 115 ? 1 : (v - 35) / 40; };
+        return 16 + 36 * level(c.r) + 6 * level(c.g) + level(c.b);
+    }
+
+    // Nearest of the 16 basic colours, as an SGR foreground code (30-37, 90-97).
+    static int basic_index(rgb c) {
+        static const rgb palette[16] = {
+            {0, 0, 0}, {205, 0, 0}, {0, 205, 0}, {205, 205, 0},
+            {0, 0, 238}, {205, 0, 205}, {0, 205, 205}, {229, 229, 229},
+            {127, 127, 127}, {255, 0, 0}, {0, 255, 0}, {255, 255, 0},
+            {92, 92, 255}, {255, 0, 255}, {0, 255, 255}, {255, 255, 255}
+        };
+        int best = 0;
+        long best_distance = std::numeric_limits<long>::max();
+        for (int i = 0; i < 16; ++i) {
+            long dr = c.r - palette[i].r, dg = c.g - palette[i].g, db = c.b - palette[i].b;
+            long distance = dr * dr + dg * dg + db * db;
+            if (distance < best_distance) { best_distance = distance; best = i; }
+        }
+        return best < 8 ? 30 + best : 90 + (best - 8);
+    }
+};
+
 // =============================================================================
 // Theme System
 // =============================================================================
@@ -168,13 +575,18 @@ struct theme {
     const char* right_pad;
     const char* left_bracket;
     const char* right_bracket;
+    // Bar colour hue (0..1 around the HSV wheel) at 0% and at 100%.
+    double hue_from;
+    double hue_to;
 
 #ifdef TQDM_CPP14
     constexpr
 #endif
     theme(std::array<const char*, 9> b, const char* rp,
-          const char* lb = "", const char* rb = "")
-        : blocks(b), right_pad(rp), left_bracket(lb), right_bracket(rb) {}
+          const char* lb = "", const char* rb = "",
+          double hf = 0.0, double ht = 1.0 / 3.0)
+        : blocks(b), right_pad(rp), left_bracket(lb), right_bracket(rb)
+        , hue_from(hf), hue_to(ht) {}
 };
 
 namespace themes {
@@ -215,6 +627,79 @@ namespace themes {
 // Thread-Safe Progress Tracker
 // =============================================================================
 
+// How get_rate() turns samples into a rate. Every estimator is recomputed at
+// most once per cache period by a single caller, in constant time.
+//   ring   - count difference since the oldest of the last 64 samples.
+//   ema    - exponential moving average of the rate between queries, like
+//            Python tqdm's `smoothing`; advance() never reads the clock.
+//   window - count difference over a fixed time window kept in buckets;
+//            advance() never reads the clock.
+enum class rate_estimator { ring, ema, window };
+
+struct tracker_options {
+    // Number of per-thread counter shards (rounded up to a power of two).
+    // 0 keeps a single shared counter. With shards enabled advance() only
+    // touches the calling thread's cache line and the rate history is
+    // sampled when the tracker is read instead of on every advance.
+    std::size_t shards = 0;
+
+    // How often advance() records a (count, timestamp) pair for the rate
+    // estimate. 1 samples every call; N samples whenever the count crosses
+    // a multiple of N (rounded up to a power of two); 0 never reads the
+    // clock on advance and samples when the rate is queried instead.
+    std::size_t sample_every = 1;
+
+    rate_estimator estimator = rate_estimator::ring;
+
+    // Weight of the latest interval for rate_estimator::ema, in [0, 1];
+    // 0 yields the average rate since start.
+    double smoothing = 0.3;
+
+    // Time span covered by rate_estimator::window.
+    std::chrono::milliseconds window{10000};
+
+    // Counts are items, or bytes shown with decimal or binary prefixes.
+    unit_scale units = unit_scale::items;
+
+    // External storage for the count, e.g. a shared_progress_segment slot.
+    // advance() then increments it in place; ignored when shards > 0.
+    std::atomic<std::size_t>* counter = nullptr;
+
+    // Fixed-point resolution: the counter holds progress * scale, so a
+    // fractional amount is one integer fetch_add rather than a CAS loop on a
+    // double. current() and total() stay in these ticks; rates, values and
+    // the displays are in progress units. 0 picks the default, which is 1
+    // for a plain tracker and 2^20 for progress_bar<float/double>.
+    std::size_t scale = 0;
+};
+
+namespace detail {
+constexpr std::size_t default_fractional_scale = std::size_t(1) << 20;
+
+// Progress in units to counter ticks, saturating instead of wrapping.
+template<typename V>
+std::size_t to_ticks(V v, std::size_t scale, std::true_type /*floating*/) noexcept {
+    auto ticks = static_cast<double>(v) * static_cast<double>(scale);
+    if (!(ticks > 0.0)) return 0;
+    const auto limit = static_cast<double>(std::numeric_limits<std::size_t>::max() / 2);
+    if (ticks >= limit) return static_cast<std::size_t>(limit);
+    return static_cast<std::size_t>(std::nearbyint(ticks));
+}
+template<typename V>
+std::size_t to_ticks(V v, std::size_t scale, std::false_type /*floating*/) noexcept {
+    if (v <= 0) return 0;
+    auto n = static_cast<std::size_t>(v);
+    if (scale > 1 && n > std::numeric_limits<std::size_t>::max() / scale) {
+        return std::numeric_limits<std::size_t>::max();
+    }
+    return n * scale;
+}
+template<typename V>
+std::size_t to_ticks(V v, std::size_t scale) noexcept {
+    return to_ticks(v, scale, std::is_floating_point<V>());
+}
+} // namespace detail
+
 template<typename ClockT = std::chrono::steady_clock>
 class progress_tracker {
 private:
@@ -224,286 +709,1540 @@ private:
         std::atomic<int64_t> timestamp{0};
     };
     mutable std::array<history_entry, HISTORY_SIZE> history_;
-    
+
+    struct alignas(64) counter_shard {
+        std::atomic<std::size_t> value{0};
+        std::atomic<std::size_t> weight{0};
+    };
+    detail::aligned_array<counter_shard> shards_;
+    std::size_t shard_mask_{0};
+    unsigned sample_shift_{0};
+    bool sample_on_read_{false};
+
     std::atomic<std::size_t> current_{0};
+    std::atomic<std::size_t>* counter_;
     std::atomic<std::size_t> total_{0};
+    // Optional per-item cost, e.g. bytes per file: when a total weight is
+    // set, percentage() and eta() follow weight instead of item count.
+    std::atomic<std::size_t> weight_done_{0};
+    std::atomic<std::size_t> weight_total_{0};
     const typename ClockT::time_point start_time_;
-    std::atomic<std::size_t> history_index_{0};
-
-    struct stats_cache {
-        double rate{0.0};
-        std::chrono::milliseconds elapsed{0};
-        typename ClockT::time_point last_update;
+    mutable std::atomic<std::size_t> history_index_{0};
+
+    // Rate cache published through a seqlock. An odd sequence means a
+    // recompute is in progress; readers never wait for it, they return the
+    // last published rate instead.
+    static constexpr int64_t CACHE_PERIOD_US = 100000;
+    mutable std::atomic<std::uint64_t> cache_seq_{0};
+    mutable std::atomic<double> cache_rate_{0.0};
+    mutable std::atomic<int64_t> cache_stamp_us_{std::numeric_limits<int64_t>::min() / 2};
+
+    // Estimator state. Only the caller holding the odd cache sequence
+    // touches it, so it needs no atomics of its own.
+    static constexpr std::size_t WINDOW_BUCKETS = 8;
+    struct window_bucket {
+        int64_t epoch;
+        std::size_t count;
+        int64_t us;
     };
-    mutable stats_cache cache_;
+    unit_scale units_;
+    std::size_t scale_;
+    rate_estimator estimator_;
+    double smoothing_;
+    int64_t bucket_us_;
+    mutable std::size_t last_count_{0};
+    mutable int64_t last_us_{0};
+    mutable double ema_dn_{0.0};
+    mutable double ema_dt_{0.0};
+    mutable std::array<window_bucket, WINDOW_BUCKETS> buckets_;
+
+    void record_sample(std::size_t progress, typename ClockT::time_point now) const noexcept {
+        auto idx = history_index_.fetch_add(1, std::memory_order_relaxed) % HISTORY_SIZE;
+        auto timestamp = std::chrono::duration_cast<std::chrono::microseconds>(now - start_time_).count();
+        history_[idx].progress.store(progress, std::memory_order_relaxed);
+        history_[idx].timestamp.store(timestamp, std::memory_order_relaxed);
+    }
 
-#ifdef TQDM_CPP17
-    mutable std::shared_mutex cache_mutex_;
-#else
-    mutable std::mutex cache_mutex_;
-#endif
+    // Unsharded count, sampling the clock every 2^sample_shift_ items.
+    void count(std::size_t n) noexcept {
+        auto before = counter_->fetch_add(n, std::memory_order_relaxed);
+        if (sample_on_read_) return;
+        auto after = before + n;
+        if ((before >> sample_shift_) != (after >> sample_shift_)) record_sample(after, ClockT::now());
+    }
 
 public:
     explicit progress_tracker(std::size_t total)
-        : total_(total), start_time_(ClockT::now()) {
+        : progress_tracker(total, tracker_options()) {}
+
+    progress_tracker(std::size_t total, const tracker_options& options)
+        : counter_(options.counter ? options.counter : &current_)
+        , total_(total), start_time_(ClockT::now())
+        , units_(options.units)
+        , scale_(options.scale > 0 ? options.scale : 1)
+        , estimator_(options.estimator)
+        , smoothing_(std::min(std::max(options.smoothing, 0.0), 1.0))
+        , bucket_us_(std::max<int64_t>(1000, std::chrono::duration_cast<std::chrono::microseconds>(
+              options.window).count() / static_cast<int64_t>(WINDOW_BUCKETS))) {
+        for (auto& b : buckets_) b = window_bucket{-1, 0, 0};
         history_[0].progress.store(0);
         history_[0].timestamp.store(0);
+        if (options.shards > 0) {
+            auto count = detail::round_up_pow2(options.shards);
+            shards_.reset(count);
+            shard_mask_ = count - 1;
+        }
+        sample_on_read_ = shards_ || options.sample_every == 0 || estimator_ != rate_estimator::ring;
+        if (options.sample_every > 1) {
+            auto stride = detail::round_up_pow2(options.sample_every);
+            while ((std::size_t(1) << sample_shift_) < stride) ++sample_shift_;
+        }
     }
 
+    // Once a total weight is set, items advanced without a weight count as
+    // weight 1 each, so mixing both forms keeps the percentage moving.
     void advance(std::size_t n = 1) noexcept {
-        auto new_progress = current_.fetch_add(n, std::memory_order_relaxed) + n;
-        auto idx = history_index_.fetch_add(1, std::memory_order_relaxed) % HISTORY_SIZE;
-        auto now = ClockT::now();
-        auto timestamp = std::chrono::duration_cast<std::chrono::microseconds>(now - start_time_).count();
-        history_[idx].progress.store(new_progress, std::memory_order_relaxed);
-        history_[idx].timestamp.store(timestamp, std::memory_order_relaxed);
+        if (weight_total_.load(std::memory_order_relaxed) != 0) {
+            advance(n, n);
+            return;
+        }
+        if (shards_) {
+            shards_[detail::thread_slot() & shard_mask_].value.fetch_add(n, std::memory_order_relaxed);
+            return;
+        }
+        count(n);
+    }
+
+    // n items that together cost `weight`.
+    void advance(std::size_t n, std::size_t weight) noexcept {
+        if (shards_) {
+            auto& shard = shards_[detail::thread_slot() & shard_mask_];
+            shard.weight.fetch_add(weight, std::memory_order_relaxed);
+            shard.value.fetch_add(n, std::memory_order_relaxed);
+            return;
+        }
+        weight_done_.fetch_add(weight, std::memory_order_relaxed);
+        count(n);
+    }
+
+    // Expected cost of all items, set up front or added as items are
+    // discovered.
+    void set_total_weight(std::size_t weight) noexcept { weight_total_.store(weight, std::memory_order_relaxed); }
+    void add_total_weight(std::size_t weight) noexcept { weight_total_.fetch_add(weight, std::memory_order_relaxed); }
+    std::size_t total_weight() const noexcept { return weight_total_.load(std::memory_order_relaxed); }
+    bool weighted() const noexcept { return total_weight() > 0; }
+
+    std::size_t done_weight() const noexcept {
+        if (!shards_) return weight_done_.load(std::memory_order_relaxed);
+        std::size_t sum = 0;
+        for (std::size_t i = 0; i <= shard_mask_; ++i) {
+            sum += shards_[i].weight.load(std::memory_order_relaxed);
+        }
+        return sum;
     }
 
     void set_total(std::size_t total) noexcept { total_.store(total, std::memory_order_relaxed); }
-    std::size_t current() const noexcept { return current_.load(std::memory_order_relaxed); }
+    void add_total(std::size_t n) noexcept { total_.fetch_add(n, std::memory_order_relaxed); }
+    void remove_total(std::size_t n) noexcept { total_.fetch_sub(n, std::memory_order_relaxed); }
     std::size_t total() const noexcept { return total_.load(std::memory_order_relaxed); }
+    unit_scale units() const noexcept { return units_; }
+    std::size_t scale() const noexcept { return scale_; }
+    bool sharded() const noexcept { return static_cast<bool>(shards_); }
+    bool samples_on_read() const noexcept { return sample_on_read_; }
+
+    std::size_t current() const noexcept {
+        if (!shards_) return counter_->load(std::memory_order_relaxed);
+        std::size_t sum = 0;
+        for (std::size_t i = 0; i <= shard_mask_; ++i) {
+            sum += shards_[i].value.load(std::memory_order_relaxed);
+        }
+        return sum;
+    }
+
+    // current() and total() in progress units.
+    double current_value() const noexcept {
+        return static_cast<double>(current()) / static_cast<double>(scale_);
+    }
+    double total_value() const noexcept {
+        return static_cast<double>(total()) / static_cast<double>(scale_);
+    }
 
     double percentage() const noexcept {
+        auto w = total_weight();
+        if (w > 0) return std::min(100.0 * static_cast<double>(done_weight()) / static_cast<double>(w), 100.0);
         auto t = total_.load(std::memory_order_relaxed);
         if (t == 0) return 0.0;
-        auto c = current_.load(std::memory_order_relaxed);
+        auto c = current();
         return std::min(100.0 * static_cast<double>(c) / static_cast<double>(t), 100.0);
     }
 
     double get_rate() const noexcept {
         auto now = ClockT::now();
+        auto now_us = std::chrono::duration_cast<std::chrono::microseconds>(now - start_time_).count();
 
-        {
-#ifdef TQDM_CPP17
-            std::shared_lock<std::shared_mutex> lock(cache_mutex_);
-#else
-            std::lock_guard<std::mutex> lock(cache_mutex_);
-#endif
-            if (std::chrono::duration_cast<std::chrono::milliseconds>(now - cache_.last_update).count() < 100) {
-                return cache_.rate;
-            }
+        auto seq = cache_seq_.load(std::memory_order_acquire);
+        if (seq & 1) return cache_rate_.load(std::memory_order_relaxed);
+
+        auto stamp = cache_stamp_us_.load(std::memory_order_relaxed);
+        auto cached = cache_rate_.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (cache_seq_.load(std::memory_order_relaxed) == seq && now_us - stamp < CACHE_PERIOD_US) {
+            return cached;
         }
 
-        std::size_t oldest_idx = 0;
-        int64_t oldest_time = std::numeric_limits<int64_t>::max();
-        std::size_t newest_idx = 0;
-        int64_t newest_time = 0;
+        // Stale: the caller that moves the sequence to odd recomputes, any
+        // concurrent caller keeps using the previous value.
+        if (!cache_seq_.compare_exchange_strong(seq, seq + 1, std::memory_order_acquire,
+                                                std::memory_order_relaxed)) {
+            return cache_rate_.load(std::memory_order_relaxed);
+        }
 
-        auto current_idx = history_index_.load(std::memory_order_relaxed);
-        std::size_t entries_to_check = std::min<std::size_t>(HISTORY_SIZE, current_idx);
+        auto rate = compute_rate(now) / static_cast<double>(scale_);
+        cache_rate_.store(rate, std::memory_order_relaxed);
+        cache_stamp_us_.store(now_us, std::memory_order_relaxed);
+        cache_seq_.store(seq + 2, std::memory_order_release);
+        return rate;
+    }
 
-        for (std::size_t i = 0; i < entries_to_check; ++i) {
-            auto time = history_[i].timestamp.load(std::memory_order_relaxed);
-            if (time > 0) {
-                if (time < oldest_time) {
-                    oldest_time = time;
-                    oldest_idx = i;
-                }
-                if (time > newest_time) {
-                    newest_time = time;
-                    newest_idx = i;
-                }
-            }
+private:
+    double compute_rate(typename ClockT::time_point now) const noexcept {
+        auto now_us = std::chrono::duration_cast<std::chrono::microseconds>(now - start_time_).count();
+        switch (estimator_) {
+        case rate_estimator::ema: return ema_rate(current(), now_us);
+        case rate_estimator::window: return window_rate(current(), now_us);
+        case rate_estimator::ring: break;
         }
+        return ring_rate(now, now_us);
+    }
+
+    static double rate_between(std::size_t from_count, int64_t from_us,
+                               std::size_t to_count, int64_t to_us) noexcept {
+        if (to_us <= from_us || to_count < from_count) return 0.0;
+        return 1e6 * static_cast<double>(to_count - from_count) / static_cast<double>(to_us - from_us);
+    }
 
-        double rate = 0.0;
-        if (newest_time > oldest_time && newest_idx != oldest_idx) {
-            auto progress_diff = history_[newest_idx].progress.load() - history_[oldest_idx].progress.load();
-            auto time_diff = newest_time - oldest_time;
-            if (time_diff > 0) {
-                rate = 1e6 * static_cast<double>(progress_diff) / static_cast<double>(time_diff);
+    double ring_rate(typename ClockT::time_point now, int64_t now_us) const noexcept {
+        // Sampled trackers keep no per-advance history; sample the counter
+        // here, at most once per cache period.
+        auto count = current();
+        if (sample_on_read_) record_sample(count, now);
+
+        // The ring is written round-robin, so the oldest sample is the slot
+        // the next write will claim (or slot 0 before the first wrap). A
+        // writer racing on that slot can leave it half-updated; such a pair
+        // fails the ordering checks and the average is used instead.
+        auto written = history_index_.load(std::memory_order_relaxed);
+        if (written >= 2) {
+            const auto& oldest = history_[written >= HISTORY_SIZE ? written % HISTORY_SIZE : 0];
+            auto stamp = oldest.timestamp.load(std::memory_order_relaxed);
+            auto progress = oldest.progress.load(std::memory_order_relaxed);
+            if (stamp > 0 && stamp < now_us && progress <= count) {
+                return rate_between(progress, stamp, count, now_us);
             }
         }
+        // Not enough history yet (e.g. a sampled tracker read for the first
+        // time): fall back to the average since start.
+        return rate_between(0, 0, count, now_us);
+    }
 
-                {
-        #ifdef TQDM_CPP17
-                    std::lock_guard<std::shared_mutex> lock(cache_mutex_);
-        #else
-                    std::lock_guard<std::mutex> lock(cache_mutex_);
-        #endif
-                    cache_.rate = rate;
-                    cache_.last_update = now;
-                    cache_.elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - start_time_);
-                }
-        return rate;
+    double ema_rate(std::size_t count, int64_t now_us) const noexcept {
+        if (smoothing_ <= 0.0) return rate_between(0, 0, count, now_us);
+        if (now_us <= last_us_) return ema_dt_ > 0.0 ? 1e6 * ema_dn_ / ema_dt_ : 0.0;
+        // Smooth the count and time deltas separately, as Python tqdm does;
+        // the start-up bias of the two averages cancels in the ratio.
+        auto dn = count >= last_count_ ? static_cast<double>(count - last_count_) : 0.0;
+        auto dt = static_cast<double>(now_us - last_us_);
+        last_count_ = count;
+        last_us_ = now_us;
+        ema_dn_ = smoothing_ * dn + (1.0 - smoothing_) * ema_dn_;
+        ema_dt_ = smoothing_ * dt + (1.0 - smoothing_) * ema_dt_;
+        return ema_dt_ > 0.0 ? 1e6 * ema_dn_ / ema_dt_ : 0.0;
+    }
+
+    double window_rate(std::size_t count, int64_t now_us) const noexcept {
+        auto epoch = now_us / bucket_us_;
+        auto& slot = buckets_[static_cast<std::size_t>(epoch) % WINDOW_BUCKETS];
+        if (slot.epoch != epoch) slot = window_bucket{epoch, count, now_us};
+
+        // Rate since the first sample of the oldest bucket still inside the
+        // window; buckets left empty by a gap in queries are skipped.
+        auto first = std::max<int64_t>(0, epoch - static_cast<int64_t>(WINDOW_BUCKETS) + 1);
+        for (auto e = first; e <= epoch; ++e) {
+            const auto& b = buckets_[static_cast<std::size_t>(e) % WINDOW_BUCKETS];
+            if (b.epoch == e && b.us < now_us) return rate_between(b.count, b.us, count, now_us);
+        }
+        return rate_between(0, 0, count, now_us);
     }
 
+public:
+
     std::chrono::milliseconds elapsed() const noexcept {
         return std::chrono::duration_cast<std::chrono::milliseconds>(ClockT::now() - start_time_);
     }
 
     std::chrono::milliseconds eta() const noexcept {
+        if (weighted()) return weighted_eta();
         auto rate = get_rate();
         if (rate <= 0) return std::chrono::milliseconds(0);
-        auto remaining = total_.load() - current_.load();
-        auto eta_seconds = static_cast<double>(remaining) / rate;
+        auto total = total_.load();
+        auto done = current();
+        if (done >= total) return std::chrono::milliseconds(0);
+        auto remaining = total - done;
+        auto eta_seconds = static_cast<double>(remaining) / static_cast<double>(scale_) / rate;
         return std::chrono::milliseconds(static_cast<int64_t>(eta_seconds * 1000));
     }
-};
-
-// =============================================================================
-// Display Policy System
-// =============================================================================
 
-class display_policy {
-public:
-    virtual ~display_policy() = default;
-    virtual void render(const progress_tracker<>& tracker) = 0;
-    virtual void finish(const progress_tracker<>& tracker) = 0;
+private:
+    // Remaining weight at the average weight throughput since start. Item
+    // costs vary by design here, so a recent item rate would swing with
+    // every large or small item; the long-run weight rate does not.
+    std::chrono::milliseconds weighted_eta() const noexcept {
+        auto total = total_weight();
+        auto done = done_weight();
+        if (done == 0 || done >= total) return std::chrono::milliseconds(0);
+        auto elapsed_ms = static_cast<double>(elapsed().count());
+        auto remaining = static_cast<double>(total - done);
+        return std::chrono::milliseconds(static_cast<int64_t>(elapsed_ms * remaining / static_cast<double>(done)));
+    }
 };
 
-template<typename ThemeT = decltype(themes::unicode)>
-class bar_display : public display_policy {
+// Minimal tracker for large numbers of bars (e.g. one per file): a count, a
+// total and a start time, 24 bytes in all. It keeps no history, so the rate is
+// the average since start, and it is not sharded.
+class compact_tracker {
 private:
-    ThemeT theme_;
-    std::size_t width_;
-    bool use_color_;
-    std::atomic<int> last_width_{0};
-    std::string label_;
-    bool show_rate_;
-    bool show_eta_;
-    bool show_percentage_;
-
-public:
-    bar_display(ThemeT theme = themes::unicode,
-                std::size_t width = 40,
-                bool use_color = true,
-                bool show_rate = true,
-                bool show_eta = true,
-                bool show_percentage = true)
-        : theme_(theme)
-        , width_(width)
-        , use_color_(use_color && is_tty())
-        , show_rate_(show_rate)
-        , show_eta_(show_eta)
-        , show_percentage_(show_percentage) {}
+    using clock = std::chrono::steady_clock;
 
-    void set_label(const std::string& label) { label_ = label; }
-
-    void render(const progress_tracker<>& tracker) override {
-        std::ostringstream oss;
+    std::atomic<std::size_t> current_{0};
+    std::atomic<std::size_t> total_{0};
+    int64_t start_ns_{0};
 
-        if (!label_.empty()) oss << label_ << ": ";
+    int64_t elapsed_ns() const noexcept {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now().time_since_epoch()).count()
+             - start_ns_;
+    }
 
-        auto percentage = tracker.percentage();
+public:
+    compact_tracker() noexcept { reset(0); }
+    explicit compact_tracker(std::size_t total) noexcept { reset(total); }
 
-        if (show_percentage_) {
-            oss << std::setw(3) << std::fixed << std::setprecision(0) << percentage << "% ";
-        }
+    compact_tracker(const compact_tracker&) = delete;
+    compact_tracker& operator=(const compact_tracker&) = delete;
 
-        if (use_color_) {
-            auto color = hsv_to_rgb(percentage / 300.0, 0.8, 1.0);
-            oss << "\033[38;2;" << color.r << ";" << color.g << ";" << color.b << "m";
-        }
+    // Restarts the tracker; not safe against concurrent advance().
+    void reset(std::size_t total) noexcept {
+        current_.store(0, std::memory_order_relaxed);
+        total_.store(total, std::memory_order_relaxed);
+        start_ns_ = std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now().time_since_epoch()).count();
+    }
 
-        oss << theme_.left_bracket;
+    void advance(std::size_t n = 1) noexcept { current_.fetch_add(n, std::memory_order_relaxed); }
+    void set_total(std::size_t total) noexcept { total_.store(total, std::memory_order_relaxed); }
+    std::size_t current() const noexcept { return current_.load(std::memory_order_relaxed); }
+    std::size_t total() const noexcept { return total_.load(std::memory_order_relaxed); }
 
-        double fills = (percentage / 100.0) * width_;
-        int whole_fills = static_cast<int>(fills);
-        double fraction = fills - whole_fills;
+    double percentage() const noexcept {
+        auto t = total();
+        if (t == 0) return 0.0;
+        return std::min(100.0 * static_cast<double>(current()) / static_cast<double>(t), 100.0);
+    }
 
-        for (int i = 0; i < whole_fills && i < static_cast<int>(width_); ++i) {
-            oss << theme_.blocks[8];
-        }
+    double get_rate() const noexcept {
+        auto ns = elapsed_ns();
+        return ns > 0 ? 1e9 * static_cast<double>(current()) / static_cast<double>(ns) : 0.0;
+    }
 
-        if (whole_fills < static_cast<int>(width_)) {
-            int frac_idx = static_cast<int>(fraction * 8);
-            if (frac_idx < 0) frac_idx = 0;
-            if (frac_idx > 8) frac_idx = 8;
-            oss << theme_.blocks[frac_idx];
-            for (int i = whole_fills + 1; i < static_cast<int>(width_); ++i) {
-                oss << theme_.blocks[0];
-            }
-        }
+    std::chrono::milliseconds elapsed() const noexcept {
+        return std::chrono::milliseconds(elapsed_ns() / 1000000);
+    }
 
-        oss << theme_.right_bracket;
+    std::chrono::milliseconds eta() const noexcept {
+        auto rate = get_rate();
+        auto done = current();
+        auto t = total();
+        if (rate <= 0 || done >= t) return std::chrono::milliseconds(0);
+        return std::chrono::milliseconds(static_cast<int64_t>(1000.0 * static_cast<double>(t - done) / rate));
+    }
+};
 
-        if (use_color_) oss << "\033[0m";
+static_assert(sizeof(compact_tracker) <= 3 * sizeof(std::uint64_t), "compact_tracker should stay 24 bytes");
 
-        oss << theme_.right_pad << " ";
+// Arena of compact_trackers allocated in fixed blocks, with a free list for
+// reuse. acquire() and release() only allocate when a new block is needed;
+// per tracker the pool costs the tracker itself plus one free-list pointer.
+// Trackers stay at a fixed address until the pool is destroyed.
+class tracker_pool {
+private:
+    static constexpr std::size_t BLOCK_SIZE = 4096;
+
+    std::vector<std::unique_ptr<compact_tracker[]>> blocks_;
+    std::vector<compact_tracker*> free_;
+    mutable std::mutex mutex_;
+
+    void grow() {
+        blocks_.emplace_back(new compact_tracker[BLOCK_SIZE]);
+        auto needed = blocks_.size() * BLOCK_SIZE;
+        if (needed > free_.capacity()) free_.reserve(std::max(needed, 2 * free_.capacity()));
+        auto* block = blocks_.back().get();
+        for (std::size_t i = BLOCK_SIZE; i-- > 0;) free_.push_back(block + i);
+    }
 
-        oss << tracker.current() << "/" << tracker.total();
+public:
+    explicit tracker_pool(std::size_t capacity = 0) {
+        while (blocks_.size() * BLOCK_SIZE < capacity) grow();
+    }
 
-        if (show_rate_) {
-            auto rate = tracker.get_rate();
-            oss << " [" << format_rate(rate);
-        }
+    tracker_pool(const tracker_pool&) = delete;
+    tracker_pool& operator=(const tracker_pool&) = delete;
 
-        if (show_rate_ || show_eta_) {
-            auto elapsed = tracker.elapsed();
-            oss << ", " << format_time(elapsed);
-            if (show_eta_ && percentage < 100.0) {
-                auto eta = tracker.eta();
-                oss << "<" << format_time(eta);
-            }
-            oss << "]";
-        }
+    compact_tracker* acquire(std::size_t total) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (free_.empty()) grow();
+        auto* tracker = free_.back();
+        free_.pop_back();
+        tracker->reset(total);
+        return tracker;
+    }
 
-        std::string output = oss.str();
-        auto current_width = static_cast<int>(output.length());
-        auto last = last_width_.exchange(current_width);
-        if (last > current_width) output.append(last - current_width, ' ');
+    void release(compact_tracker* tracker) noexcept {
+        if (!tracker) return;
+        std::lock_guard<std::mutex> lock(mutex_);
+        free_.push_back(tracker);  // capacity reserved in grow()
+    }
 
-        std::cout << '\r' << output << std::flush;
+    std::size_t capacity() const noexcept {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return blocks_.size() * BLOCK_SIZE;
     }
 
-    void finish(const progress_tracker<>& tracker) override {
-        render(tracker);
-        std::cout << '\n';
+    std::size_t in_use() const noexcept {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return blocks_.size() * BLOCK_SIZE - free_.size();
     }
 };
 
-// =============================================================================
-// Main Progress Bar Class
-// =============================================================================
-
-template<typename T = std::size_t>
-class progress_bar {
+namespace detail {
+// Append-only storage for short strings such as labels, carved from 4 KiB
+// blocks so that many of them cost their bytes rather than an allocation
+// each. Replaced strings are reclaimed only with the arena.
+class string_arena {
 private:
-    std::unique_ptr<progress_tracker<>> tracker_;
-    std::unique_ptr<display_policy> display_;
-    std::atomic<bool> finished_{false};
+    static constexpr std::size_t BLOCK_SIZE = 4096;
 
-    std::atomic<int64_t> last_render_time_{0};
-    static constexpr auto min_render_interval = std::chrono::milliseconds(33);
-
-    std::mutex render_mutex_;
+    std::vector<std::unique_ptr<char[]>> blocks_;
+    std::size_t used_{BLOCK_SIZE};  // in the last block
 
 public:
-    explicit progress_bar(T total,
-                          std::unique_ptr<display_policy> display = nullptr)
-        : tracker_(new progress_tracker<>(static_cast<std::size_t>(total)))
-        , display_(display ? std::move(display)
-                           : std::make_unique<bar_display<decltype(themes::unicode)>>()) {
-        if (is_tty()) {
-            std::lock_guard<std::mutex> lock(render_mutex_);
-            display_->render(*tracker_);
+    const char* store(const char* data, std::size_t size) {
+        if (size == 0) return nullptr;
+        if (size > BLOCK_SIZE) {
+            blocks_.emplace_back(new char[size]);
+            used_ = BLOCK_SIZE;
+            std::memcpy(blocks_.back().get(), data, size);
+            return blocks_.back().get();
         }
+        if (used_ + size > BLOCK_SIZE) {
+            blocks_.emplace_back(new char[BLOCK_SIZE]);
+            used_ = 0;
+        }
+        auto* out = blocks_.back().get() + used_;
+        std::memcpy(out, data, size);
+        used_ += size;
+        return out;
     }
+};
+} // namespace detail
 
-    // Custom move constructor, do not move mutex
+// =============================================================================
+// Display Policy System
+// =============================================================================
+
+class display_policy {
+public:
+    virtual ~display_policy() = default;
+    virtual void render(const progress_tracker<>& tracker) = 0;
+    virtual void finish(const progress_tracker<>& tracker) = 0;
+    virtual void set_label(const std::string&) {}
+    // Displays that draw on the terminal are skipped when stdout is not a
+    // TTY; sinks that write elsewhere return false to keep running.
+    virtual bool requires_tty() const { return true; }
+};
+
+// Draws nothing. As a progress_bar display parameter it removes rendering at
+// compile time, leaving advance() as the tracker increment alone.
+class null_display final : public display_policy {
+public:
+    void render(const progress_tracker<>&) override {}
+    void finish(const progress_tracker<>&) override {}
+};
+
+// Turns consecutive single-line frames into the minimal terminal update: the
+// frame is split into cells (one UTF-8 code point each, with the SGR colour
+// escape active at that point), compared against the previous frame, and only
+// differing runs are emitted behind cursor-column jumps. Each code point is
+// assumed to occupy one column, which holds for all built-in themes.
+class frame_differ {
+private:
+    struct cell {
+        std::uint32_t offset;
+        std::uint32_t style_offset;
+        std::uint16_t length;
+        std::uint16_t style_length;
+    };
+
+    frame_buffer prev_;
+    frame_buffer out_;
+    std::vector<cell> prev_cells_;
+    std::vector<cell> cells_;
+    std::size_t cursor_{0};
+    bool has_prev_{false};
+
+    static void split(const frame_buffer& frame, std::vector<cell>& cells) {
+        cells.clear();
+        const char* data = frame.data();
+        std::size_t size = frame.size();
+        std::uint32_t style_offset = 0;
+        std::uint16_t style_length = 0;
+        std::size_t i = 0;
+        while (i < size && cells.size() < cells.capacity()) {
+            auto c = static_cast<unsigned char>(data[i]);
+            if (c == 0x1b && i + 1 < size && data[i + 1] == '[') {
+                std::size_t j = i + 2;
+                while (j < size && !(data[j] >= 0x40 && data[j] <= 0x7e)) ++j;
+                std::size_t end = std::min(j + 1, size);
+                bool reset = (end - i == 4 && data[i + 2] == '0') || end - i == 3;
+                style_offset = static_cast<std::uint32_t>(i);
+                style_length = reset ? 0 : static_cast<std::uint16_t>(end - i);
+                i = end;
+                continue;
+            }
+            std::size_t len = c < 0x80 ? 1 : c >= 0xf0 ? 4 : c >= 0xe0 ? 3 : c >= 0xc0 ? 2 : 1;
+            len = std::min(len, size - i);
+            cells.push_back(cell{static_cast<std::uint32_t>(i), style_offset,
+                                 static_cast<std::uint16_t>(len), style_length});
+            i += len;
+        }
+    }
+
+    static bool same_style(const char* a, const cell& x, const char* b, const cell& y) {
+        return x.style_length == y.style_length &&
+               std::memcmp(a + x.style_offset, b + y.style_offset, x.style_length) == 0;
+    }
+
+    bool same_cell(const frame_buffer& next, std::size_t i) const {
+        const cell& x = cells_[i];
+        const cell& y = prev_cells_[i];
+        return x.length == y.length &&
+               std::memcmp(next.data() + x.offset, prev_.data() + y.offset, x.length) == 0 &&
+               same_style(next.data(), x, prev_.data(), y);
+    }
+
+    void move_to(std::size_t column) {
+        if (column == cursor_) return;
+        if (column < cursor_) {
+            out_.append('\r');
+            cursor_ = 0;
+            if (column == 0) return;
+        }
+        out_.append("\033[");
+        out_.append_uint(column - cursor_);
+        out_.append('C');
+        cursor_ = column;
+    }
+
+    void emit(const frame_buffer& next, std::size_t first, std::size_t last) {
+        move_to(first);
+        const cell* active = nullptr;
+        for (std::size_t i = first; i < last; ++i) {
+            const cell& c = cells_[i];
+            if (active ? !same_style(next.data(), *active, next.data(), c) : c.style_length != 0) {
+                if (c.style_length) out_.append(next.data() + c.style_offset, c.style_length);
+                else out_.append("\033[0m");
+            }
+            active = &c;
+            out_.append(next.data() + c.offset, c.length);
+        }
+        if (active && active->style_length) out_.append("\033[0m");
+        cursor_ = last;
+    }
+
+public:
+    void reserve(std::size_t frame_capacity) {
+        prev_.reserve(frame_capacity);
+        out_.reserve(4 * frame_capacity + 64);
+        prev_cells_.reserve(frame_capacity);
+        cells_.reserve(frame_capacity);
+    }
+
+    // Forget the previous frame; the next diff() redraws the whole line.
+    void reset() noexcept { has_prev_ = false; }
+
+    // Returns the bytes that turn the previously diffed frame into `next`.
+    // The result is empty when nothing visible changed.
+    const frame_buffer& diff(const frame_buffer& next) {
+        static constexpr std::size_t MERGE_GAP = 4;
+        out_.clear();
+        split(next, cells_);
+
+        if (!has_prev_) {
+            out_.append('\r');
+            out_.append(next.data(), next.size());
+            out_.append("\033[K");
+            cursor_ = cells_.size();
+        } else {
+            std::size_t n = cells_.size();
+            std::size_t m = prev_cells_.size();
+            auto unchanged = [&](std::size_t i) { return i < m && same_cell(next, i); };
+
+            std::size_t i = 0;
+            while (i < n) {
+                if (unchanged(i)) { ++i; continue; }
+                std::size_t j = i + 1;
+                for (;;) {
+                    while (j < n && !unchanged(j)) ++j;
+                    // Bridge short unchanged gaps: rewriting a few cells is
+                    // cheaper than another cursor jump.
+                    std::size_t k = j;
+                    while (k < n && k - j < MERGE_GAP && unchanged(k)) ++k;
+                    if (k < n && k - j < MERGE_GAP && !unchanged(k)) { j = k; continue; }
+                    break;
+                }
+                emit(next, i, j);
+                i = j;
+            }
+            if (n < m) {
+                move_to(n);
+                out_.append("\033[K");
+            }
+        }
+
+        prev_.clear();
+        prev_.reserve(next.size());
+        prev_.append(next.data(), next.size());
+        prev_cells_.swap(cells_);
+        has_prev_ = true;
+        return out_;
+    }
+};
+
+namespace detail {
+// Trackers without a units() member (e.g. compact_tracker) count items.
+template<typename TrackerT>
+auto tracker_units(const TrackerT& tracker, int) -> decltype(tracker.units()) {
+    return tracker.units();
+}
+template<typename TrackerT>
+unit_scale tracker_units(const TrackerT&, long) { return unit_scale::items; }
+
+// Likewise, trackers without a scale() count whole ticks.
+template<typename TrackerT>
+auto tracker_scale(const TrackerT& tracker, int) -> decltype(tracker.scale()) {
+    return tracker.scale();
+}
+template<typename TrackerT>
+std::size_t tracker_scale(const TrackerT&, long) { return 1; }
+
+// A count of ticks in progress units: a plain integer for whole items, one
+// decimal for fractional progress, or a byte size.
+inline void append_count(frame_buffer& out, std::size_t ticks, std::size_t scale, unit_scale units) noexcept {
+    auto value = static_cast<double>(ticks) / static_cast<double>(scale);
+    if (units != unit_scale::items) append_bytes(out, value, units);
+    else if (scale == 1) out.append_uint(ticks);
+    else out.append_fixed1(value);
+}
+} // namespace detail
+
+template<typename ThemeT = decltype(themes::unicode)>
+class bar_display : public display_policy {
+private:
+    ThemeT theme_;
+    std::size_t width_;
+    const color_gradient* colors_{nullptr};  // null when colour is off
+    std::atomic<int> last_width_{0};
+    std::string label_;
+    bool show_rate_;
+    bool show_eta_;
+    bool show_percentage_;
+    bool incremental_{false};
+    frame_buffer frame_;
+    frame_differ differ_;
+    // The bar's full and empty cells pre-rendered at full width: a frame
+    // copies a prefix of each instead of appending glyphs one cell at a time.
+    std::size_t full_glyph_;
+    std::size_t empty_glyph_;
+    std::string full_strip_;
+    std::string empty_strip_;
+
+    static std::string repeat_glyph(const char* glyph, std::size_t count) {
+        std::size_t len = std::strlen(glyph);
+        std::string strip;
+        strip.reserve(len * count);
+        for (std::size_t i = 0; i < count; ++i) strip.append(glyph, len);
+        return strip;
+    }
+
+    std::size_t frame_capacity() const {
+        std::size_t glyph = 1;
+        for (auto* block : theme_.blocks) glyph = std::max(glyph, std::strlen(block));
+        // Fixed text: percentage, colour escapes, counts, rate and times.
+        return 192 + label_.size() + width_ * glyph
+             + std::strlen(theme_.left_bracket) + std::strlen(theme_.right_bracket)
+             + std::strlen(theme_.right_pad);
+    }
+
+public:
+    bar_display(ThemeT theme = themes::unicode,
+                std::size_t width = 40,
+                bool use_color = true,
+                bool show_rate = true,
+                bool show_eta = true,
+                bool show_percentage = true)
+        : theme_(theme)
+        , width_(width)
+        , show_rate_(show_rate)
+        , show_eta_(show_eta)
+        , show_percentage_(show_percentage)
+        , frame_(frame_capacity())
+        , full_glyph_(std::strlen(theme_.blocks[8]))
+        , empty_glyph_(std::strlen(theme_.blocks[0]))
+        , full_strip_(repeat_glyph(theme_.blocks[8], width_))
+        , empty_strip_(repeat_glyph(theme_.blocks[0], width_)) {
+        if (use_color) set_color_mode(detect_color_mode());
+    }
+
+    // Override the detected colour support, e.g. force ansi256 for a
+    // terminal that does not advertise truecolor. color_mode::none turns
+    // colour off.
+    void set_color_mode(color_mode mode) {
+        colors_ = mode == color_mode::none
+            ? nullptr
+            : &color_gradient::shared(mode, theme_.hue_from, theme_.hue_to);
+    }
+
+    color_mode get_color_mode() const noexcept {
+        return colors_ ? colors_->mode() : color_mode::none;
+    }
+
+    void set_label(const std::string& label) override {
+        label_ = label;
+        frame_.reserve(frame_capacity());
+        if (incremental_) differ_.reserve(frame_.capacity());
+    }
+
+    // Only rewrite the cells that changed since the previous frame and skip
+    // the write entirely when nothing visible changed. Assumes nothing else
+    // writes to the bar's line between frames.
+    void set_incremental(bool enabled) {
+        incremental_ = enabled;
+        if (enabled) differ_.reserve(frame_.capacity());
+        differ_.reset();
+    }
+
+    // Builds the frame for the tracker's current state into the display's
+    // own buffer and returns it. The buffer is sized at construction (and on
+    // set_label), so composing a frame never allocates. Any tracker with the
+    // progress_tracker read interface works, e.g. a compact_tracker.
+    template<typename TrackerT>
+    const frame_buffer& compose(const TrackerT& tracker) {
+        return compose(tracker, label_.data(), label_.size());
+    }
+
+    // Same with a label held by the caller instead of the display's own, so
+    // one display can draw many lines. The buffer grows only when a label is
+    // longer than any composed before.
+    template<typename TrackerT>
+    const frame_buffer& compose(const TrackerT& tracker, const char* label, std::size_t label_size) {
+        if (label_size > label_.size() && frame_.capacity() < frame_capacity() + label_size - label_.size()) {
+            frame_.reserve(frame_capacity() + label_size - label_.size());
+            if (incremental_) differ_.reserve(frame_.capacity());
+        }
+        frame_.clear();
+
+        if (label_size) { frame_.append(label, label_size); frame_.append(": "); }
+
+        if (tracker.total() == 0) return compose_unbounded(tracker);
+
+        auto percentage = tracker.percentage();
+
+        if (show_percentage_) {
+            frame_.append_uint(static_cast<unsigned long long>(std::nearbyint(percentage)), 3);
+            frame_.append("% ");
+        }
+
+        if (colors_) colors_->append(frame_, percentage);
+
+        frame_.append(theme_.left_bracket);
+
+        double fills = std::max(0.0, (percentage / 100.0) * width_);
+        auto whole_fills = std::min(static_cast<std::size_t>(fills), width_);
+        double fraction = fills - static_cast<double>(whole_fills);
+
+        frame_.append(full_strip_.data(), whole_fills * full_glyph_);
+
+        if (whole_fills < width_) {
+            int frac_idx = static_cast<int>(fraction * 8);
+            if (frac_idx < 0) frac_idx = 0;
+            if (frac_idx > 8) frac_idx = 8;
+            frame_.append(theme_.blocks[frac_idx]);
+            auto empty = width_ - whole_fills - 1;
+            frame_.append(empty_strip_.data(), empty * empty_glyph_);
+        }
+
+        frame_.append(theme_.right_bracket);
+
+        if (colors_) frame_.append("\033[0m");
+
+        frame_.append(theme_.right_pad);
+        frame_.append(' ');
+
+        auto units = detail::tracker_units(tracker, 0);
+        auto scale = detail::tracker_scale(tracker, 0);
+        detail::append_count(frame_, tracker.current(), scale, units);
+        frame_.append('/');
+        detail::append_count(frame_, tracker.total(), scale, units);
+
+        if (show_rate_) {
+            frame_.append(" [");
+            append_rate(frame_, tracker.get_rate(), units);
+        }
+
+        if (show_rate_ || show_eta_) {
+            frame_.append(", ");
+            append_time(frame_, tracker.elapsed());
+            if (show_eta_ && percentage < 100.0) {
+                frame_.append('<');
+                append_time(frame_, tracker.eta());
+            }
+            frame_.append(']');
+        }
+
+        return frame_;
+    }
+
+private:
+    // Unknown total: no percentage, bar or ETA, just the count, rate and
+    // elapsed time after the label.
+    template<typename TrackerT>
+    const frame_buffer& compose_unbounded(const TrackerT& tracker) {
+        auto units = detail::tracker_units(tracker, 0);
+        detail::append_count(frame_, tracker.current(), detail::tracker_scale(tracker, 0), units);
+        if (show_rate_) {
+            frame_.append(" [");
+            append_rate(frame_, tracker.get_rate(), units);
+            frame_.append(", ");
+        } else {
+            frame_.append(" [");
+        }
+        append_time(frame_, tracker.elapsed());
+        frame_.append(']');
+        return frame_;
+    }
+
+public:
+    void render(const progress_tracker<>& tracker) override {
+        compose(tracker);
+        if (incremental_) {
+            auto& update = differ_.diff(frame_);
+            if (update.size() == 0) return;
+            std::cout.write(update.data(), static_cast<std::streamsize>(update.size()));
+            std::cout.flush();
+            return;
+        }
+        auto current_width = static_cast<int>(frame_.size());
+        auto last = last_width_.exchange(current_width);
+        if (last > current_width) frame_.append(static_cast<std::size_t>(last - current_width), ' ');
+
+        std::cout.put('\r');
+        std::cout.write(frame_.data(), static_cast<std::streamsize>(frame_.size()));
+        std::cout.flush();
+    }
+
+    void finish(const progress_tracker<>& tracker) override {
+        render(tracker);
+        std::cout << '\n';
+        differ_.reset();
+    }
+};
+
+// =============================================================================
+// Background Renderer
+// =============================================================================
+
+enum class render_mode {
+    caller,     // render from advance() on whichever thread wins the throttle
+    background  // render from a shared renderer thread; advance() never renders
+};
+
+// One process-wide thread that wakes every refresh interval and runs the
+// registered render callbacks. Callbacks run outside the registry lock, so a
+// callback may add or remove targets; once remove() returns on any other
+// thread the removed callback is guaranteed not to be running.
+class background_renderer {
+private:
+    struct target {
+        const void* key;
+        std::function<void()> tick;
+        bool removed;
+    };
+
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable idle_;  // signalled after each callback returns
+    std::vector<std::shared_ptr<target>> targets_;
+    std::vector<std::shared_ptr<target>> pass_;  // renderer thread only
+    const void* running_{nullptr};               // key of the callback in flight
+    std::thread thread_;
+    bool stopping_{false};
+
+    background_renderer() = default;
+
+    void run() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (!stopping_) {
+            if (targets_.empty()) {
+                wake_.wait(lock);
+                continue;
+            }
+            wake_.wait_for(lock, refresh_interval());
+            if (stopping_) break;
+            pass_ = targets_;
+            for (auto& entry : pass_) {
+                if (entry->removed) continue;
+                running_ = entry->key;
+                lock.unlock();
+                entry->tick();
+                lock.lock();
+                running_ = nullptr;
+                idle_.notify_all();
+                if (stopping_) break;
+            }
+            pass_.clear();
+        }
+    }
+
+public:
+    static std::chrono::milliseconds refresh_interval() { return std::chrono::milliseconds(33); }
+
+    static background_renderer& instance() {
+        static background_renderer renderer;
+        return renderer;
+    }
+
+    ~background_renderer() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        wake_.notify_all();
+        if (thread_.joinable()) thread_.join();
+    }
+
+    background_renderer(const background_renderer&) = delete;
+    background_renderer& operator=(const background_renderer&) = delete;
+
+    void add(const void* key, std::function<void()> tick) {
+        std::shared_ptr<target> entry(new target{key, std::move(tick), false});
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            targets_.push_back(std::move(entry));
+            if (!thread_.joinable()) thread_ = std::thread([this] { run(); });
+        }
+        wake_.notify_all();
+    }
+
+    // Called from a callback, returns at once; the caller is the callback in
+    // flight, and the removed target is skipped for the rest of the pass.
+    void remove(const void* key) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        auto match = [key](const std::shared_ptr<target>& t) { return t->key == key; };
+        for (auto& entry : targets_) {
+            if (match(entry)) entry->removed = true;
+        }
+        targets_.erase(std::remove_if(targets_.begin(), targets_.end(), match), targets_.end());
+        if (std::this_thread::get_id() == thread_.get_id()) return;
+        idle_.wait(lock, [this, key] { return running_ != key; });
+    }
+};
+
+// =============================================================================
+// Refresh Scheduling
+// =============================================================================
+
+// When a bar redraws, following Python tqdm's knobs. The interval between
+// frames starts at mininterval and grows so that rendering (compose, write
+// and flush, as measured) stays within `budget` of wall time, e.g. on a slow
+// serial console or a high-latency SSH session; it never exceeds
+// maxinterval. miniters additionally requires that many counts between
+// frames. In background mode the renderer thread's tick is the lower bound.
+struct refresh_options {
+    std::chrono::milliseconds mininterval{33};
+    std::chrono::milliseconds maxinterval{10000};
+    std::size_t miniters = 0;
+    double budget = 0.001;  // fraction of wall time; 0 keeps mininterval
+};
+
+namespace detail {
+inline int64_t steady_ns() noexcept {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Per-bar frame deadline. claim() is called on the advance path and lets one
+// caller through once the deadline (and miniters) allow; rendered() then
+// folds the measured cost into the next interval. rendered() runs only for
+// the caller that claimed the frame, under the bar's render lock.
+class refresh_scheduler {
+private:
+    static constexpr double COST_SMOOTHING = 0.2;
+
+    int64_t min_ns_{0};
+    int64_t max_ns_{0};
+    std::size_t miniters_{0};
+    double budget_{0.0};
+    std::atomic<double> cost_ns_{0.0};  // written by the renderer, read by render_cost()
+    std::atomic<int64_t> interval_ns_{0};
+    std::atomic<int64_t> next_ns_{0};
+    std::atomic<std::size_t> next_count_{0};
+
+public:
+    explicit refresh_scheduler(const refresh_options& options = refresh_options()) { configure(options); }
+
+    void configure(const refresh_options& options) noexcept {
+        min_ns_ = std::chrono::duration_cast<std::chrono::nanoseconds>(options.mininterval).count();
+        max_ns_ = std::max(min_ns_, static_cast<int64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(options.maxinterval).count()));
+        miniters_ = options.miniters;
+        budget_ = options.budget;
+        interval_ns_.store(min_ns_, std::memory_order_relaxed);
+        next_ns_.store(0, std::memory_order_relaxed);
+    }
+
+    template<typename TrackerT>
+    bool claim(int64_t now_ns, const TrackerT& tracker) noexcept {
+        auto next = next_ns_.load(std::memory_order_relaxed);
+        if (now_ns < next) return false;
+        if (miniters_ && tracker.current() < next_count_.load(std::memory_order_relaxed)) return false;
+        // Push the deadline out now so concurrent callers back off while
+        // this one renders.
+        return next_ns_.compare_exchange_strong(next, now_ns + interval_ns_.load(std::memory_order_relaxed),
+                                                std::memory_order_relaxed);
+    }
+
+    void rendered(int64_t start_ns, int64_t end_ns, std::size_t count) noexcept {
+        auto cost = static_cast<double>(std::max<int64_t>(0, end_ns - start_ns));
+        auto smoothed = cost_ns_.load(std::memory_order_relaxed);
+        smoothed = smoothed > 0.0 ? COST_SMOOTHING * cost + (1.0 - COST_SMOOTHING) * smoothed : cost;
+        cost_ns_.store(smoothed, std::memory_order_relaxed);
+
+        auto interval = min_ns_;
+        if (budget_ > 0.0) {
+            auto wanted = smoothed / budget_;
+            if (wanted > static_cast<double>(max_ns_)) wanted = static_cast<double>(max_ns_);
+            interval = std::max(min_ns_, static_cast<int64_t>(wanted));
+        }
+        interval_ns_.store(interval, std::memory_order_relaxed);
+        next_ns_.store(end_ns + interval, std::memory_order_relaxed);
+        next_count_.store(count + miniters_, std::memory_order_relaxed);
+    }
+
+    std::chrono::nanoseconds interval() const noexcept {
+        return std::chrono::nanoseconds(interval_ns_.load(std::memory_order_relaxed));
+    }
+    std::chrono::nanoseconds render_cost() const noexcept {
+        return std::chrono::nanoseconds(static_cast<int64_t>(cost_ns_.load(std::memory_order_relaxed)));
+    }
+};
+} // namespace detail
+
+// =============================================================================
+// Profiling
+// =============================================================================
+
+struct profile_options {
+    // A bar that does not advance for this long is recorded as stalled.
+    std::chrono::milliseconds stall_threshold{500};
+    // Events kept in the ring (rounded up to a power of two); the oldest
+    // are overwritten once it is full.
+    std::size_t capacity = std::size_t(1) << 16;
+};
+
+// Opt-in trace of every progress_bar: one span per bar from construction to
+// finish, a throughput counter per frame and a span for each stall. Events
+// go into a lock-free ring and are written as Chrome trace JSON (load it in
+// chrome://tracing or ui.perfetto.dev), each bar on its own track. Enable it
+// from code or by setting TQDM_TRACE=<path>; the trace is then written at
+// exit. Only bars created after enable() are traced. Everything is recorded
+// on the render path, so advance() is unchanged except that bars which do
+// not draw (e.g. with stdout redirected) still claim frames while tracing.
+class profiler {
+public:
+    enum class event_kind : std::uint32_t { span, stall, rate };
+
+    static profiler& instance() {
+        static profiler p;
+        // After p is constructed, so the exit hook runs before p is destroyed.
+        static bool from_environment = p.enable_from_environment();
+        (void)from_environment;
+        return p;
+    }
+
+    // Starts recording. Call before creating the bars to trace, and only
+    // once; later calls just change the dump path. An empty path keeps the
+    // trace in memory for write()/dump().
+    void enable(const std::string& path = "", const profile_options& options = profile_options()) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!path.empty()) {
+            path_ = path;
+            if (!exit_hook_) {
+                exit_hook_ = true;
+                std::atexit([] { instance().dump_at_exit(); });
+            }
+        }
+        if (enabled_.load(std::memory_order_relaxed)) return;
+        auto capacity = detail::round_up_pow2(std::max<std::size_t>(options.capacity, 64));
+        ring_.reset(new slot[capacity]);
+        mask_ = capacity - 1;
+        stall_ns_ = std::chrono::duration_cast<std::chrono::nanoseconds>(options.stall_threshold).count();
+        origin_ns_ = detail::steady_ns();
+        enabled_.store(true, std::memory_order_release);
+    }
+
+    bool enabled() const noexcept { return enabled_.load(std::memory_order_acquire); }
+    int64_t stall_threshold_ns() const noexcept { return stall_ns_; }
+
+    // A new track; the name can be changed until the trace is written.
+    std::uint32_t register_bar(const std::string& name) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        names_.push_back(name);
+        return static_cast<std::uint32_t>(names_.size() - 1);
+    }
+    void rename_bar(std::uint32_t id, const std::string& name) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (id < names_.size()) names_[id] = name;
+    }
+
+    // Lock-free: a ticket from one fetch_add picks the slot, the slot's
+    // sequence is published last so readers skip half-written events.
+    void record(event_kind kind, std::uint32_t bar, int64_t start_ns, int64_t duration_ns, double value) noexcept {
+        auto ticket = head_.fetch_add(1, std::memory_order_relaxed);
+        auto& e = ring_[ticket & mask_];
+        e.seq.store(0, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        e.kind.store(static_cast<std::uint32_t>(kind), std::memory_order_relaxed);
+        e.bar.store(bar, std::memory_order_relaxed);
+        e.start_ns.store(start_ns, std::memory_order_relaxed);
+        e.duration_ns.store(duration_ns, std::memory_order_relaxed);
+        e.value.store(value, std::memory_order_relaxed);
+        e.seq.store(ticket + 1, std::memory_order_release);
+    }
+
+    // Events lost to ring wrap-around so far.
+    std::size_t dropped() const noexcept {
+        if (!ring_) return 0;
+        auto head = head_.load(std::memory_order_relaxed);
+        return head > mask_ + 1 ? static_cast<std::size_t>(head - (mask_ + 1)) : 0;
+    }
+
+    void write(std::ostream& out) const {
+        std::vector<std::string> names;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            names = names_;
+        }
+        // Microsecond timestamps with nanosecond digits, never in exponent form.
+        auto flags = out.flags();
+        auto precision = out.precision();
+        out.setf(std::ios::fixed, std::ios::floatfield);
+        out.precision(3);
+        out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+        bool first = true;
+        auto separator = [&] { if (!first) out << ",\n"; first = false; };
+        for (std::size_t id = 0; id < names.size(); ++id) {
+            separator();
+            out << "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":" << id
+                << ",\"args\":{\"name\":\"" << escape(track_name(names, id)) << "\"}}";
+        }
+        if (ring_) {
+            auto head = head_.load(std::memory_order_acquire);
+            auto begin = head > mask_ + 1 ? head - (mask_ + 1) : 0;
+            for (auto ticket = begin; ticket < head; ++ticket) {
+                const auto& e = ring_[ticket & mask_];
+                if (e.seq.load(std::memory_order_acquire) != ticket + 1) continue;
+                auto kind = static_cast<event_kind>(e.kind.load(std::memory_order_relaxed));
+                auto bar = e.bar.load(std::memory_order_relaxed);
+                auto ts = static_cast<double>(e.start_ns.load(std::memory_order_relaxed) - origin_ns_) / 1e3;
+                auto dur = static_cast<double>(e.duration_ns.load(std::memory_order_relaxed)) / 1e3;
+                auto value = e.value.load(std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (e.seq.load(std::memory_order_relaxed) != ticket + 1) continue;
+
+                separator();
+                auto name = escape(track_name(names, bar));
+                switch (kind) {
+                case event_kind::span:
+                    out << "{\"ph\":\"X\",\"cat\":\"progress\",\"name\":\"" << name << "\",\"pid\":1,\"tid\":" << bar
+                        << ",\"ts\":" << ts << ",\"dur\":" << dur << ",\"args\":{\"items\":" << value << "}}";
+                    break;
+                case event_kind::stall:
+                    out << "{\"ph\":\"X\",\"cat\":\"stall\",\"name\":\"stall\",\"pid\":1,\"tid\":" << bar
+                        << ",\"ts\":" << ts << ",\"dur\":" << dur << "}";
+                    break;
+                case event_kind::rate:
+                    out << "{\"ph\":\"C\",\"name\":\"" << name << " /s\",\"pid\":1,\"tid\":" << bar
+                        << ",\"ts\":" << ts << ",\"args\":{\"rate\":" << value << "}}";
+                    break;
+                }
+            }
+        }
+        out << "]}\n";
+        out.flags(flags);
+        out.precision(precision);
+    }
+
+    bool dump(const std::string& path) const {
+        std::ofstream out(path);
+        if (!out) return false;
+        write(out);
+        return static_cast<bool>(out);
+    }
+
+private:
+    struct slot {
+        std::atomic<std::uint64_t> seq{0};
+        std::atomic<std::uint32_t> kind{0};
+        std::atomic<std::uint32_t> bar{0};
+        std::atomic<int64_t> start_ns{0};
+        std::atomic<int64_t> duration_ns{0};
+        std::atomic<double> value{0.0};
+    };
+
+    std::atomic<bool> enabled_{false};
+    std::unique_ptr<slot[]> ring_;
+    std::uint64_t mask_{0};
+    std::atomic<std::uint64_t> head_{0};
+    int64_t stall_ns_{0};
+    int64_t origin_ns_{0};
+    mutable std::mutex mutex_;
+    std::vector<std::string> names_;
+    std::string path_;
+    bool exit_hook_{false};
+
+    profiler() = default;
+
+    bool enable_from_environment() {
+        const char* path = std::getenv("TQDM_TRACE");
+        if (!path || !*path) return false;
+        enable(path);
+        return true;
+    }
+
+    void dump_at_exit() {
+        std::string path;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            path = path_;
+        }
+        if (!path.empty()) dump(path);
+    }
+
+    static std::string track_name(const std::vector<std::string>& names, std::size_t id) {
+        if (id < names.size() && !names[id].empty()) return names[id];
+        return "bar " + std::to_string(id);
+    }
+
+    static std::string escape(const std::string& text) {
+        static const char hex[] = "0123456789abcdef";
+        std::string out;
+        out.reserve(text.size());
+        for (char ch : text) {
+            auto c = static_cast<unsigned char>(ch);
+            if (c == '"' || c == '\\') { out += '\\'; out += ch; }
+            else if (c < 0x20) { out += "\\u00"; out += hex[c >> 4]; out += hex[c & 0xf]; }
+            else out += ch;
+        }
+        return out;
+    }
+};
+
+namespace detail {
+// Per-bar trace state, touched only by the thread that renders the bar.
+// Stalls are found from frames: a frame is claimed by the first advance()
+// after the refresh deadline, so a gap between frames longer than the
+// interval means nothing advanced in between; when frames keep coming
+// without progress (background rendering) the quiet time is accumulated.
+class bar_probe {
+    profiler& profiler_;
+    std::uint32_t id_;
+    int64_t start_ns_;
+    int64_t last_frame_ns_;
+    int64_t quiet_since_ns_{0};  // 0 while the count keeps moving
+    std::size_t last_count_{0};
+
+    void stall(int64_t from_ns, int64_t to_ns) noexcept {
+        if (to_ns - from_ns >= profiler_.stall_threshold_ns()) {
+            profiler_.record(profiler::event_kind::stall, id_, from_ns, to_ns - from_ns, 0.0);
+        }
+    }
+
+public:
+    explicit bar_probe(profiler& p)
+        : profiler_(p), id_(p.register_bar("")), start_ns_(steady_ns()), last_frame_ns_(start_ns_) {}
+
+    void rename(const std::string& label) { profiler_.rename_bar(id_, label); }
+
+    void frame(int64_t now_ns, std::size_t count, int64_t interval_ns) noexcept {
+        if (count != last_count_) {
+            auto quiet = quiet_since_ns_ ? quiet_since_ns_
+                                         : std::min(now_ns, last_frame_ns_ + interval_ns);
+            stall(quiet, now_ns);
+            auto span = now_ns - last_frame_ns_;
+            if (span > 0) {
+                profiler_.record(profiler::event_kind::rate, id_, now_ns, 0,
+                                 1e9 * static_cast<double>(count - last_count_) / static_cast<double>(span));
+            }
+            last_count_ = count;
+            quiet_since_ns_ = 0;
+        } else if (!quiet_since_ns_) {
+            quiet_since_ns_ = last_frame_ns_;
+        }
+        last_frame_ns_ = now_ns;
+    }
+
+    void finish(std::size_t count) noexcept {
+        auto now = steady_ns();
+        if (quiet_since_ns_) stall(quiet_since_ns_, now);
+        profiler_.record(profiler::event_kind::span, id_, start_ns_, now - start_ns_, static_cast<double>(count));
+    }
+};
+} // namespace detail
+
+// =============================================================================
+// Main Progress Bar Class
+// =============================================================================
+
+// Writes compact JSON-lines progress records to a file descriptor, for log
+// shippers and batch jobs without a terminal. Records are taken at most once
+// per record interval and buffered; the buffer is written with one write(2)
+// per flush interval, when it fills up, and on finish().
+//
+//   {"label":"copy","n":420,"total":1000,"pct":42.0,"rate":81.3,
+//    "elapsed_ms":5166,"eta_ms":7134,"time_ms":1760000000000,"done":false}
+class jsonl_display : public display_policy {
+private:
+    int fd_;
+    std::chrono::milliseconds record_interval_;
+    std::chrono::milliseconds flush_interval_;
+    std::string label_;
+    frame_buffer buffer_;
+    std::chrono::steady_clock::time_point last_record_;
+    std::chrono::steady_clock::time_point last_flush_;
+    bool has_record_{false};
+
+    static constexpr std::size_t BUFFER_SIZE = 16384;
+
+    std::size_t record_capacity() const { return 256 + 6 * label_.size(); }
+
+    void append_escaped(const std::string& text) {
+        static const char hex[] = "0123456789abcdef";
+        for (char ch : text) {
+            auto c = static_cast<unsigned char>(ch);
+            if (c == '"' || c == '\\') {
+                buffer_.append('\\');
+                buffer_.append(ch);
+            } else if (c < 0x20) {
+                buffer_.append("\\u00");
+                buffer_.append(hex[c >> 4]);
+                buffer_.append(hex[c & 0xf]);
+            } else {
+                buffer_.append(ch);
+            }
+        }
+    }
+
+    void append_record(const progress_tracker<>& tracker, bool done) {
+        if (buffer_.capacity() - buffer_.size() < record_capacity()) flush();
+
+        auto ms = [](std::chrono::milliseconds d) {
+            return static_cast<unsigned long long>(std::max<int64_t>(0, d.count()));
+        };
+        auto wall = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch());
+
+        buffer_.append("{\"label\":\"");
+        append_escaped(label_);
+        buffer_.append("\",\"n\":");
+        detail::append_count(buffer_, tracker.current(), tracker.scale(), unit_scale::items);
+        buffer_.append(",\"total\":");
+        detail::append_count(buffer_, tracker.total(), tracker.scale(), unit_scale::items);
+        buffer_.append(",\"pct\":");
+        buffer_.append_fixed1(tracker.percentage());
+        buffer_.append(",\"rate\":");
+        buffer_.append_fixed1(tracker.get_rate());
+        buffer_.append(",\"elapsed_ms\":");
+        buffer_.append_uint(ms(tracker.elapsed()));
+        buffer_.append(",\"eta_ms\":");
+        buffer_.append_uint(done ? 0 : ms(tracker.eta()));
+        buffer_.append(",\"time_ms\":");
+        buffer_.append_uint(ms(wall));
+        buffer_.append(done ? ",\"done\":true}\n" : ",\"done\":false}\n");
+        has_record_ = true;
+    }
+
+    void flush() {
+        if (buffer_.size()) detail::write_all(fd_, buffer_.data(), buffer_.size());
+        buffer_.clear();
+        last_flush_ = std::chrono::steady_clock::now();
+    }
+
+public:
+    explicit jsonl_display(int fd = STDERR_FILENO,
+                           std::chrono::milliseconds record_interval = std::chrono::milliseconds(1000),
+                           std::chrono::milliseconds flush_interval = std::chrono::milliseconds(5000))
+        : fd_(fd)
+        , record_interval_(record_interval)
+        , flush_interval_(flush_interval)
+        , buffer_(BUFFER_SIZE)
+        , last_record_(std::chrono::steady_clock::now())
+        , last_flush_(last_record_) {}
+
+    ~jsonl_display() override { flush(); }
+
+    void set_label(const std::string& label) override { label_ = label; }
+    bool requires_tty() const override { return false; }
+
+    void render(const progress_tracker<>& tracker) override {
+        auto now = std::chrono::steady_clock::now();
+        if (has_record_ && now - last_record_ < record_interval_) return;
+        last_record_ = now;
+        append_record(tracker, false);
+        if (now - last_flush_ >= flush_interval_) flush();
+    }
+
+    void finish(const progress_tracker<>& tracker) override {
+        append_record(tracker, true);
+        flush();
+    }
+};
+
+namespace detail {
+template<typename DisplayT>
+struct default_display {
+    static DisplayT* make() { return new DisplayT(); }
+};
+template<>
+struct default_display<display_policy> {
+    static display_policy* make() { return new bar_display<decltype(themes::unicode)>(); }
+};
+template<>
+struct default_display<null_display> {
+    static null_display* make() { return nullptr; }
+};
+
+template<typename DisplayT>
+auto display_requires_tty(const DisplayT& display, int) -> decltype(display.requires_tty()) {
+    return display.requires_tty();
+}
+template<typename DisplayT>
+bool display_requires_tty(const DisplayT&, long) { return true; }
+} // namespace detail
+
+// DisplayT selects how the bar is drawn. The default, display_policy, is
+// type-erased: any display_policy subclass can be passed at run time and is
+// called through its vtable. A concrete DisplayT (which needs render(),
+// finish() and set_label()) is called directly, and null_display compiles the
+// rendering path out entirely.
+template<typename T = std::size_t, typename DisplayT = display_policy>
+class progress_bar {
+public:
+    // Amounts passed to advance() and returned by current()/total(): T for
+    // fractional progress (kept in fixed point, see tracker_options::scale),
+    // otherwise a whole count.
+    using step_type = typename std::conditional<std::is_floating_point<T>::value, T, std::size_t>::type;
+
+private:
+    static constexpr bool renders = !std::is_same<DisplayT, null_display>::value;
+
+    detail::aligned_ptr<progress_tracker<>> tracker_;
+    std::unique_ptr<DisplayT> display_;
+    std::atomic<bool> finished_{false};
+
+    // Only bars that can draw (or are traced) get one; see refresh_options.
+    std::unique_ptr<detail::refresh_scheduler> scheduler_;
+    std::unique_ptr<detail::bar_probe> probe_;  // set while profiling
+
+    // Serialises frames with set_label() and finish(). Heap-allocated so it
+    // moves with the display: a background callback keeps using it.
+    std::unique_ptr<std::mutex> render_mutex_{new std::mutex()};
+    bool background_{false};
+    bool active_{false};  // has a display that can draw in this process
+
+    // Abstract displays dispatch virtually; concrete ones get a qualified,
+    // statically bound call.
+    static void render_with(DisplayT& display, const progress_tracker<>& tracker, std::true_type) {
+        display.render(tracker);
+    }
+    static void render_with(DisplayT& display, const progress_tracker<>& tracker, std::false_type) {
+        display.DisplayT::render(tracker);
+    }
+    static void render_with(DisplayT& display, const progress_tracker<>& tracker) {
+        render_with(display, tracker, std::is_abstract<DisplayT>());
+    }
+
+public:
+    explicit progress_bar(T total,
+                          std::unique_ptr<DisplayT> display = nullptr)
+        : progress_bar(total, tracker_options(), std::move(display)) {}
+
+    progress_bar(T total, const tracker_options& options,
+                 std::unique_ptr<DisplayT> display = nullptr)
+        : tracker_(detail::make_aligned<progress_tracker<>>(detail::to_ticks(total, scaled(options).scale), scaled(options)))
+        , display_(display ? std::move(display)
+                           : std::unique_ptr<DisplayT>(detail::default_display<DisplayT>::make())) {
+        active_ = renders && display_ && (is_tty() || !detail::display_requires_tty(*display_, 0));
+        if (renders && profiler::instance().enabled()) probe_.reset(new detail::bar_probe(profiler::instance()));
+        if (active_ || probe_) {
+            scheduler_.reset(new detail::refresh_scheduler());
+            timed_render(detail::steady_ns());
+        }
+    }
+
+    // Custom move constructor; the render mutex moves with the display
     progress_bar(progress_bar&& other) noexcept
         : tracker_(std::move(other.tracker_))
         , display_(std::move(other.display_))
         , finished_(other.finished_.load(std::memory_order_relaxed))
-        , last_render_time_(other.last_render_time_.load(std::memory_order_relaxed)) {
+        , scheduler_(std::move(other.scheduler_))
+        , probe_(std::move(other.probe_))
+        , render_mutex_(std::move(other.render_mutex_))
+        , background_(other.background_)
+        , active_(other.active_) {
         other.finished_.store(true, std::memory_order_relaxed);
+        other.background_ = false;
+        other.active_ = false;
     }
 
-    // Custom move assignment, do not move mutex
+    // Custom move assignment; the render mutex moves with the display
     progress_bar& operator=(progress_bar&& other) noexcept {
         if (this != &other) {
+            detach_background();
             tracker_ = std::move(other.tracker_);
             display_ = std::move(other.display_);
             finished_.store(other.finished_.load(std::memory_order_relaxed), std::memory_order_relaxed);
-            last_render_time_.store(other.last_render_time_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            scheduler_ = std::move(other.scheduler_);
+            probe_ = std::move(other.probe_);
+            render_mutex_ = std::move(other.render_mutex_);
+            background_ = other.background_;
+            active_ = other.active_;
             other.finished_.store(true, std::memory_order_relaxed);
+            other.background_ = false;
+            other.active_ = false;
         }
         return *this;
     }
 
     ~progress_bar() {
-        if (!finished_.load() && is_tty()) finish();
+        if (!finished_.load()) finish();
+        detach_background();
     }
 
     // Disable copy
@@ -511,70 +2250,686 @@ public:
     progress_bar& operator=(const progress_bar&) = delete;
 
     progress_bar& operator++() { advance(1); return *this; }
-    progress_bar& operator+=(std::size_t n) { advance(n); return *this; }
+    progress_bar& operator+=(step_type n) { advance(n); return *this; }
 
-    void advance(std::size_t n = 1) {
-        if (tracker_) tracker_->advance(n);
-        try_render();
+    void advance(step_type n = 1) {
+        if (tracker_) tracker_->advance(detail::to_ticks(n, tracker_->scale()));
+        if (renders && !background_) try_render();
     }
 
+    // Weighted progress: n items costing `weight` in total; see
+    // set_total_weight().
+    void advance(step_type n, std::size_t weight) {
+        if (tracker_) tracker_->advance(detail::to_ticks(n, tracker_->scale()), weight);
+        if (renders && !background_) try_render();
+    }
+
+    void set_total_weight(std::size_t weight) { if (tracker_) tracker_->set_total_weight(weight); }
+    void add_total_weight(std::size_t weight) { if (tracker_) tracker_->add_total_weight(weight); }
+
+    // Switch between rendering on the caller's advance() path and rendering
+    // from the shared background_renderer thread. Call before the bar is
+    // shared between threads. Combine with a sharded tracker to make
+    // advance() a plain counter increment with no clock read.
+    void set_render_mode(render_mode mode) {
+        if (mode == render_mode::background) {
+            if (!renders || !active_ || background_ || finished_.load() || !tracker_) return;
+            auto* tracker = tracker_.get();
+            auto* display = display_.get();
+            auto* scheduler = scheduler_.get();
+            auto* probe = probe_.get();
+            auto* mutex = render_mutex_.get();
+            background_renderer::instance().add(tracker, [tracker, display, scheduler, probe, mutex] {
+                auto start = detail::steady_ns();
+                if (!scheduler->claim(start, *tracker)) return;
+                std::lock_guard<std::mutex> lock(*mutex);
+                render_with(*display, *tracker);
+                auto count = tracker->current();
+                if (probe) probe->frame(start, count, scheduler->interval().count());
+                scheduler->rendered(start, detail::steady_ns(), count);
+            });
+            background_ = true;
+        } else {
+            detach_background();
+        }
+    }
+
+    // Safe while another thread (or the background renderer) draws the bar.
     void set_label(const std::string& label) {
-        if (auto* bar_disp = dynamic_cast<bar_display<>*>(display_.get())) {
-            bar_disp->set_label(label);
+        if (display_) {
+            std::lock_guard<std::mutex> lock(*render_mutex_);
+            display_->set_label(label);
         }
+        if (probe_) probe_->rename(label);
+    }
+
+    // Adjusts the refresh policy. Call before the bar is shared between
+    // threads.
+    void set_refresh(const refresh_options& options) {
+        if (scheduler_) scheduler_->configure(options);
+    }
+
+    // Current gap between frames and the smoothed cost of one frame; zero
+    // for bars that do not draw.
+    std::chrono::nanoseconds refresh_interval() const {
+        return scheduler_ ? scheduler_->interval() : std::chrono::nanoseconds(0);
+    }
+    std::chrono::nanoseconds render_cost() const {
+        return scheduler_ ? scheduler_->render_cost() : std::chrono::nanoseconds(0);
     }
 
     void finish() {
         bool expected = false;
         if (finished_.compare_exchange_strong(expected, true)) {
-            if (is_tty() && tracker_ && display_) {
-                std::lock_guard<std::mutex> lock(render_mutex_);
+            detach_background();
+            if (renders && active_ && tracker_) {
+                std::lock_guard<std::mutex> lock(*render_mutex_);
                 display_->finish(*tracker_);
             }
+            if (probe_ && tracker_) probe_->finish(tracker_->current());
         }
     }
 
-    std::size_t current() const { return tracker_ ? tracker_->current() : 0; }
-    std::size_t total() const { return tracker_ ? tracker_->total() : 0; }
+    step_type current() const {
+        return tracker_ ? from_ticks(tracker_->current(), std::is_floating_point<step_type>()) : 0;
+    }
+    step_type total() const {
+        return tracker_ ? from_ticks(tracker_->total(), std::is_floating_point<step_type>()) : 0;
+    }
     double percentage() const { return tracker_ ? tracker_->percentage() : 0.0; }
     double rate() const { return tracker_ ? tracker_->get_rate() : 0.0; }
 
+    // Late total, e.g. once a stream's length is known; 0 means unknown.
+    void set_total(step_type total) {
+        if (tracker_) tracker_->set_total(detail::to_ticks(total, tracker_->scale()));
+    }
+
 private:
+    static tracker_options scaled(tracker_options options) {
+        if (options.scale == 0) {
+            options.scale = std::is_floating_point<T>::value ? detail::default_fractional_scale : 1;
+        }
+        return options;
+    }
+
+    step_type from_ticks(std::size_t ticks, std::true_type) const {
+        return static_cast<step_type>(static_cast<double>(ticks) / static_cast<double>(tracker_->scale()));
+    }
+    step_type from_ticks(std::size_t ticks, std::false_type) const {
+        return ticks / tracker_->scale();
+    }
+
     void try_render() {
-        if (!is_tty() || !tracker_ || !display_) return;
+        if (!scheduler_ || !tracker_) return;
+        auto now = detail::steady_ns();
+        if (scheduler_->claim(now, *tracker_)) timed_render(now);
+    }
+
+    void timed_render(int64_t start_ns) {
+        std::lock_guard<std::mutex> lock(*render_mutex_);
+        if (active_) render_with(*display_, *tracker_);
+        auto count = tracker_->current();
+        if (probe_) probe_->frame(start_ns, count, scheduler_->interval().count());
+        scheduler_->rendered(start_ns, detail::steady_ns(), count);
+    }
+
+    void detach_background() {
+        if (background_) {
+            background_renderer::instance().remove(tracker_.get());
+            background_ = false;
+        }
+    }
+
+    void force_render() {
+        if (renders && active_ && tracker_) timed_render(detail::steady_ns());
+    }
+};
+
+// C++17: Class template argument deduction guides
+#if __cplusplus >= 201703L
+progress_bar(std::size_t) -> progress_bar<std::size_t>;
+progress_bar(int) -> progress_bar<int>;
+progress_bar(double) -> progress_bar<double>;
+template<typename T>
+progress_bar(T, std::unique_ptr<display_policy>) -> progress_bar<T>;
+#endif
+
+// =============================================================================
+// Multi-Bar Manager
+// =============================================================================
+
+// Draws a set of trackers as a block of lines, one per tracker. Trackers are
+// either owned (add), pooled compact_trackers (add_compact) or borrowed
+// (attach), e.g. a progress_group parent.
+// Every refresh composes all lines into one buffer, using ANSI cursor movement
+// to return to the top of the block, and emits it with a single write(2).
+// Workers only advance their tracker; nothing renders on their path.
+class multi_progress {
+private:
+    // Lines from add() and attach() have a display of their own. Compact
+    // lines share compact_display_ and keep their label in labels_, so each
+    // costs the line itself, a pooled tracker and the label's bytes.
+    struct line {
+        detail::aligned_ptr<progress_tracker<>> owned;
+        const progress_tracker<>* tracker{nullptr};
+        std::unique_ptr<bar_display<>> display;
+        const compact_tracker* compact{nullptr};  // set instead of tracker
+        const char* label{nullptr};               // compact lines only
+        std::size_t label_size{0};
+    };
+
+    // Declared first: outlive the lines that point into them.
+    tracker_pool pool_;
+    detail::string_arena labels_;
+    std::unique_ptr<bar_display<>> compact_display_;  // created by the first add_compact()
+    std::vector<line> lines_;
+    frame_buffer out_;
+    std::size_t drawn_lines_{0};
+    bool background_{false};
+    bool finished_{false};
+    mutable std::mutex mutex_;
+
+    void compose_locked() {
+        out_.clear();
+        reserve_locked(32);
+        if (drawn_lines_ > 0) {
+            out_.append("\r\033[");
+            out_.append_uint(drawn_lines_);
+            out_.append('A');
+        }
+        for (auto& l : lines_) {
+            auto& frame = l.compact ? compact_display_->compose(*l.compact, l.label, l.label_size)
+                                    : l.display->compose(*l.tracker);
+            reserve_locked(out_.size() + frame.size() + 8);
+            out_.append(frame.data(), frame.size());
+            out_.append("\033[K\n");
+        }
+        drawn_lines_ = lines_.size();
+    }
+
+    // Grows the block buffer geometrically, so once it has held a full
+    // block, later refreshes do not allocate.
+    void reserve_locked(std::size_t needed) {
+        if (needed > out_.capacity()) out_.reserve(std::max(needed, 2 * out_.capacity()));
+    }
+
+    std::size_t push_line(line l, const std::string& label) {
+        l.display.reset(new bar_display<>());
+        if (!label.empty()) l.display->set_label(label);
+        std::lock_guard<std::mutex> lock(mutex_);
+        lines_.push_back(std::move(l));
+        return lines_.size() - 1;
+    }
+
+    void detach_background() {
+        if (background_) {
+            background_renderer::instance().remove(this);
+            background_ = false;
+        }
+    }
+
+public:
+    multi_progress() = default;
+    ~multi_progress() { finish(); }
+
+    multi_progress(const multi_progress&) = delete;
+    multi_progress& operator=(const multi_progress&) = delete;
+
+    // Adds a line and returns its tracker. The reference stays valid for the
+    // lifetime of the manager and may be advanced from any thread.
+    progress_tracker<>& add(std::size_t total, const std::string& label = "",
+                            const tracker_options& options = tracker_options()) {
+        line l;
+        l.owned = detail::make_aligned<progress_tracker<>>(total, options);
+        l.tracker = l.owned.get();
+        auto& tracker = *l.owned;
+        push_line(std::move(l), label);
+        return tracker;
+    }
+
+    // Adds a line backed by a compact_tracker from the manager's own pool, for
+    // blocks of many short bars. All compact lines are drawn by one shared
+    // display, and trackers and labels come from block arenas, so a line
+    // costs tens of bytes and no malloc of its own. The rate is the average
+    // since start. The reference stays valid for the lifetime of the manager.
+    compact_tracker& add_compact(std::size_t total, const std::string& label = "") {
+        auto* tracker = pool_.acquire(total);
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!compact_display_) compact_display_.reset(new bar_display<>());
+        line l;
+        l.compact = tracker;
+        l.label = labels_.store(label.data(), label.size());
+        l.label_size = label.size();
+        lines_.push_back(std::move(l));
+        return *tracker;
+    }
+
+    // Adds a line for a tracker owned elsewhere, which must outlive the
+    // manager (or its last render). Returns the line index.
+    std::size_t attach(const progress_tracker<>& tracker, const std::string& label = "") {
+        line l;
+        l.tracker = &tracker;
+        return push_line(std::move(l), label);
+    }
+
+    void set_label(std::size_t index, const std::string& label) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (index >= lines_.size()) return;
+        auto& l = lines_[index];
+        if (l.compact) {
+            l.label = labels_.store(label.data(), label.size());
+            l.label_size = label.size();
+        } else {
+            l.display->set_label(label);
+        }
+    }
+
+    std::size_t size() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return lines_.size();
+    }
+
+    // Redraws every line with one write(2).
+    void render() {
+        if (!is_tty()) return;
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (finished_) return;
+        compose_locked();
+        std::cout.flush();
+        detail::write_all(STDOUT_FILENO, out_.data(), out_.size());
+    }
+
+    // Refresh from the shared background_renderer thread at the refresh
+    // interval, or only when render() is called explicitly.
+    void set_render_mode(render_mode mode) {
+        if (mode == render_mode::background) {
+            if (background_ || finished_ || !is_tty()) return;
+            background_renderer::instance().add(this, [this] { render(); });
+            background_ = true;
+        } else {
+            detach_background();
+        }
+    }
+
+    // Draws the final state and leaves the cursor below the block.
+    void finish() {
+        detach_background();
+        render();
+        std::lock_guard<std::mutex> lock(mutex_);
+        finished_ = true;
+    }
+};
+
+// =============================================================================
+// Progress Groups
+// =============================================================================
+
+// A parent tracker fed by short-lived child tasks. Each task counts into its
+// own pooled compact_tracker and adds the same amount straight to the
+// parent, so the parent is always the roll-up and drawing it costs the same
+// for ten tasks or ten thousand. The parent is sharded by default, which
+// keeps that second increment uncontended. A task adds its total to the
+// parent's when created; retiring it unfinished removes what was left.
+// Tasks must be retired (or destroyed) before their group.
+class progress_group {
+public:
+    class task {
+    private:
+        friend class progress_group;
+        progress_group* group_{nullptr};
+        compact_tracker* tracker_{nullptr};
+
+        task(progress_group* group, compact_tracker* tracker) noexcept
+            : group_(group), tracker_(tracker) {}
+
+    public:
+        task() = default;
+        ~task() { retire(); }
+
+        task(task&& other) noexcept : group_(other.group_), tracker_(other.tracker_) {
+            other.tracker_ = nullptr;
+        }
+
+        task& operator=(task&& other) noexcept {
+            if (this != &other) {
+                retire();
+                group_ = other.group_;
+                tracker_ = other.tracker_;
+                other.tracker_ = nullptr;
+            }
+            return *this;
+        }
+
+        task(const task&) = delete;
+        task& operator=(const task&) = delete;
+
+        explicit operator bool() const noexcept { return tracker_ != nullptr; }
+
+        void advance(std::size_t n = 1) noexcept {
+            tracker_->advance(n);
+            group_->parent_.advance(n);
+        }
+
+        // Counts whatever is left of the task's total as done.
+        void finish() noexcept {
+            if (!tracker_) return;
+            auto done = tracker_->current();
+            auto total = tracker_->total();
+            if (done < total) advance(total - done);
+        }
+
+        // Returns the tracker to the pool. Work not yet done is dropped from
+        // the parent's total so the parent can still reach 100%.
+        void retire() noexcept {
+            if (!tracker_) return;
+            auto done = tracker_->current();
+            auto total = tracker_->total();
+            if (done < total) group_->parent_.remove_total(total - done);
+            group_->pool_.release(tracker_);
+            group_->active_.fetch_sub(1, std::memory_order_relaxed);
+            tracker_ = nullptr;
+        }
+
+        const compact_tracker& tracker() const noexcept { return *tracker_; }
+    };
+
+private:
+    progress_tracker<> parent_;
+    tracker_pool pool_;
+    std::atomic<std::size_t> active_{0};
+
+    static tracker_options default_options() {
+        tracker_options options;
+        options.shards = std::max(1u, std::thread::hardware_concurrency());
+        return options;
+    }
+
+public:
+    explicit progress_group(std::size_t expected_tasks = 0)
+        : progress_group(default_options(), expected_tasks) {}
+
+    progress_group(const tracker_options& options, std::size_t expected_tasks)
+        : parent_(0, options), pool_(expected_tasks) {}
+
+    progress_group(const progress_group&) = delete;
+    progress_group& operator=(const progress_group&) = delete;
+
+    task add_task(std::size_t total) {
+        auto* tracker = pool_.acquire(total);
+        parent_.add_total(total);
+        active_.fetch_add(1, std::memory_order_relaxed);
+        return task(this, tracker);
+    }
+
+    // The roll-up, for a display or multi_progress::attach().
+    const progress_tracker<>& parent() const noexcept { return parent_; }
+    std::size_t active_tasks() const noexcept { return active_.load(std::memory_order_relaxed); }
+};
+
+// =============================================================================
+// Chunked Advancing
+// =============================================================================
+
+namespace detail {
+template<typename ProgressT>
+auto flush_progress(ProgressT& progress, int) -> decltype(progress.flush(), void()) { progress.flush(); }
+template<typename ProgressT>
+void flush_progress(ProgressT&, long) {}
+
+// Counters that weigh items (advance_item) see each element before the
+// iterator moves past it; the rest just count.
+template<typename ProgressT, typename IterT>
+auto count_item(ProgressT& progress, const IterT& it, int) -> decltype(progress.advance_item(*it), void()) {
+    progress.advance_item(*it);
+}
+template<typename ProgressT, typename IterT>
+void count_item(ProgressT& progress, const IterT&, long) { progress.advance(); }
+} // namespace detail
+
+// Counts iterator steps locally and forwards them to the bar every `chunk`
+// steps. A chunk of 0 adapts: the chunk doubles while flushes arrive faster
+// than the refresh interval and halves when they fall far behind it, so the
+// clock is read once per flush rather than once per element.
+template<typename ProgressBarT>
+class chunked_advancer {
+    ProgressBarT* bar_;
+    std::size_t pending_{0};
+    std::size_t pending_weight_{0};
+    std::size_t chunk_;
+    bool adaptive_;
+    bool weighted_{false};  // set by advance_weighted(); a zero-cost batch is still weighted
+    std::chrono::steady_clock::time_point last_flush_;
+
+    static constexpr std::size_t MAX_CHUNK = std::size_t(1) << 20;
+
+public:
+    explicit chunked_advancer(ProgressBarT* bar, std::size_t chunk = 1)
+        : bar_(bar)
+        , chunk_(chunk ? chunk : 1)
+        , adaptive_(chunk == 0)
+        , last_flush_(std::chrono::steady_clock::now()) {}
+
+    // Copies the configuration but starts with nothing pending.
+    chunked_advancer(const chunked_advancer& other, ProgressBarT* bar)
+        : bar_(bar), chunk_(other.chunk_), adaptive_(other.adaptive_), weighted_(other.weighted_)
+        , last_flush_(other.last_flush_) {}
+
+    void advance() {
+        if (++pending_ >= chunk_) flush();
+    }
+
+    // A batch counted elsewhere, e.g. in a view iterator.
+    void advance(std::size_t n) {
+        pending_ += n;
+        if (pending_ >= chunk_) flush();
+    }
+
+    // One item of the given cost.
+    void advance_weighted(std::size_t weight) {
+        weighted_ = true;
+        pending_weight_ += weight;
+        advance();
+    }
+
+    void flush() {
+        if (pending_ == 0) return;
+        if (weighted_) bar_->advance(pending_, pending_weight_);
+        else bar_->advance(pending_);
+        pending_ = 0;
+        pending_weight_ = 0;
+        if (!adaptive_) return;
 
         auto now = std::chrono::steady_clock::now();
-        auto now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count();
-        auto last_ms = last_render_time_.load(std::memory_order_relaxed);
+        auto target = background_renderer::refresh_interval();
+        auto since = now - last_flush_;
+        last_flush_ = now;
+        if (since < target / 2 && chunk_ < MAX_CHUNK) chunk_ <<= 1;
+        else if (since > target * 2 && chunk_ > 1) chunk_ >>= 1;
+    }
 
-        if (now_ms - last_ms >= min_render_interval.count()) {
-            if (last_render_time_.compare_exchange_weak(last_ms, now_ms)) {
-                std::lock_guard<std::mutex> lock(render_mutex_);
-                display_->render(*tracker_);
+    std::size_t chunk() const noexcept { return chunk_; }
+};
+
+// =============================================================================
+// Shared-Memory Export
+// =============================================================================
+
+// Fixed layout of a POSIX shared-memory progress segment, so a monitor in
+// another process can read counters a job updates in place. The segment is a
+// shm_header followed by slot_count shm_slots. Layout version 1 requires
+// 64-bit lock-free counters, so the section is compiled only where size_t is
+// 64 bits; TQDM_HAS_SHARED_SEGMENT is defined when it is available.
+#if SIZE_MAX == UINT64_MAX
+#define TQDM_HAS_SHARED_SEGMENT
+
+struct alignas(64) shm_slot {
+    enum : std::uint32_t { free_slot = 0, running = 1, finished = 2 };
+
+    std::atomic<std::size_t> current;
+    std::atomic<std::size_t> total;
+    std::atomic<std::int64_t> start_unix_ns;
+    std::atomic<std::uint32_t> state;
+    std::uint32_t reserved;
+    char label[64];
+
+    void finish() noexcept { state.store(finished, std::memory_order_release); }
+};
+
+struct alignas(64) shm_header {
+    static constexpr std::uint32_t VERSION = 1;
+
+    char magic[8];  // "TQDMSHM" plus NUL
+    std::uint32_t version;
+    std::uint32_t slot_count;
+    std::uint32_t slot_size;
+    std::uint32_t reserved;
+    std::atomic<std::uint32_t> next_slot;
+};
+
+// Owns a mapping of a named segment. create() makes (and on destruction
+// unlinks) the segment on the job side; open() maps an existing one read-only
+// for a monitor. Failures leave the object invalid rather than throwing.
+class shared_progress_segment {
+private:
+    void* base_{nullptr};
+    std::size_t size_{0};
+    std::string name_;
+    bool owner_{false};
+
+    static std::size_t bytes_for(std::size_t slots) {
+        return sizeof(shm_header) + slots * sizeof(shm_slot);
+    }
+
+    shm_header* header() const noexcept { return static_cast<shm_header*>(base_); }
+
+    // Unmaps the segment and, for the owner, removes its name.
+    void release() noexcept {
+        if (base_) ::munmap(base_, size_);
+        if (owner_) ::shm_unlink(name_.c_str());
+        base_ = nullptr;
+        size_ = 0;
+        owner_ = false;
+    }
+
+public:
+    shared_progress_segment() = default;
+
+    static shared_progress_segment create(const std::string& name, std::size_t slots) {
+        shared_progress_segment segment;
+        int fd = ::shm_open(name.c_str(), O_CREAT | O_RDWR | O_TRUNC, 0644);
+        if (fd < 0) return segment;
+        auto size = bytes_for(slots);
+        if (::ftruncate(fd, static_cast<off_t>(size)) == 0) {
+            void* base = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            if (base != MAP_FAILED) {
+                segment.base_ = base;
+                segment.size_ = size;
+                segment.name_ = name;
+                segment.owner_ = true;
+                auto* h = new (base) shm_header();
+                h->version = shm_header::VERSION;
+                h->slot_count = static_cast<std::uint32_t>(slots);
+                h->slot_size = sizeof(shm_slot);
+                h->reserved = 0;
+                h->next_slot.store(0, std::memory_order_relaxed);
+                for (std::size_t i = 0; i < slots; ++i) new (segment.slot(i)) shm_slot();
+                std::memcpy(h->magic, "TQDMSHM", 8);  // published last
+            }
+        }
+        ::close(fd);
+        if (!segment.base_) ::shm_unlink(name.c_str());
+        return segment;
+    }
+
+    static shared_progress_segment open(const std::string& name) {
+        shared_progress_segment segment;
+        int fd = ::shm_open(name.c_str(), O_RDONLY, 0);
+        if (fd < 0) return segment;
+        struct stat st;
+        if (::fstat(fd, &st) == 0 && static_cast<std::size_t>(st.st_size) >= sizeof(shm_header)) {
+            auto size = static_cast<std::size_t>(st.st_size);
+            void* base = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+            if (base != MAP_FAILED) {
+                auto* h = static_cast<shm_header*>(base);
+                if (std::memcmp(h->magic, "TQDMSHM", 8) == 0 && h->version == shm_header::VERSION &&
+                    h->slot_size == sizeof(shm_slot) && bytes_for(h->slot_count) <= size) {
+                    segment.base_ = base;
+                    segment.size_ = size;
+                    segment.name_ = name;
+                } else {
+                    ::munmap(base, size);
+                }
             }
         }
+        ::close(fd);
+        return segment;
+    }
+
+    shared_progress_segment(shared_progress_segment&& other) noexcept
+        : base_(other.base_), size_(other.size_), name_(std::move(other.name_)), owner_(other.owner_) {
+        other.base_ = nullptr;
+        other.owner_ = false;
+    }
+
+    shared_progress_segment& operator=(shared_progress_segment&& other) noexcept {
+        if (this != &other) {
+            release();
+            base_ = other.base_;
+            size_ = other.size_;
+            name_ = std::move(other.name_);
+            owner_ = other.owner_;
+            other.base_ = nullptr;
+            other.owner_ = false;
+        }
+        return *this;
+    }
+
+    ~shared_progress_segment() { release(); }
+
+    shared_progress_segment(const shared_progress_segment&) = delete;
+    shared_progress_segment& operator=(const shared_progress_segment&) = delete;
+
+    explicit operator bool() const noexcept { return base_ != nullptr; }
+    std::size_t slot_count() const noexcept { return base_ ? header()->slot_count : 0; }
+
+    shm_slot* slot(std::size_t index) const noexcept {
+        if (!base_ || index >= header()->slot_count) return nullptr;
+        auto* first = reinterpret_cast<char*>(base_) + sizeof(shm_header);
+        return reinterpret_cast<shm_slot*>(first + index * sizeof(shm_slot));
+    }
+
+    // Claims the next free slot (job side); nullptr when the segment is full.
+    shm_slot* acquire(const std::string& label, std::size_t total) noexcept {
+        if (!base_ || !owner_) return nullptr;
+        auto index = header()->next_slot.fetch_add(1, std::memory_order_relaxed);
+        auto* s = slot(index);
+        if (!s) return nullptr;
+        std::size_t n = std::min(label.size(), sizeof(s->label) - 1);
+        std::memcpy(s->label, label.data(), n);
+        s->label[n] = '\0';
+        s->total.store(total, std::memory_order_relaxed);
+        s->current.store(0, std::memory_order_relaxed);
+        s->start_unix_ns.store(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count(), std::memory_order_relaxed);
+        s->state.store(shm_slot::running, std::memory_order_release);
+        return s;
     }
 
-    void force_render() {
-        if (is_tty() && tracker_ && display_) {
-            std::lock_guard<std::mutex> lock(render_mutex_);
-            display_->render(*tracker_);
-        }
+    // Tracker options that make a tracker count straight into `slot`.
+    static tracker_options tracker_options_for(shm_slot* slot) {
+        tracker_options options;
+        if (slot) options.counter = &slot->current;
+        return options;
     }
 };
-
-// C++17: Class template argument deduction guides
-#ifdef TQDM_CPP17
-progress_bar(std::size_t) -> progress_bar<std::size_t>;
-progress_bar(int) -> progress_bar<int>;
-template<typename T>
-progress_bar(T, std::unique_ptr<display_policy>) -> progress_bar<T>;
-#endif
+#endif // SIZE_MAX == UINT64_MAX
 
 // =============================================================================
 // Iterator Wrapper
 // =============================================================================
 
+// ProgressBarT needs advance() or advance_item(element); if it also has
+// flush() that is called once the iterator reaches the end of the range.
 template<typename IterT, typename ProgressBarT>
 class progress_iterator {
     IterT current_;
@@ -592,8 +2947,9 @@ public:
         : current_(current), end_(end), bar_(bar) {}
 
     progress_iterator& operator++() {
+        if (bar_) detail::count_item(*bar_, current_, 0);
         ++current_;
-        if (bar_ && current_ != end_) bar_->advance();
+        if (bar_ && current_ == end_) detail::flush_progress(*bar_, 0);
         return *this;
     }
 
@@ -614,40 +2970,153 @@ public:
 // Range Wrapper
 // =============================================================================
 
+// A begin/end pair usable as a container, e.g. for std::istream_iterator.
+template<typename IterT>
+struct iterator_range {
+    IterT first;
+    IterT last;
+    IterT begin() const { return first; }
+    IterT end() const { return last; }
+};
+
+namespace detail {
+// Length of a range when it is known without walking it: size() if the
+// container has one, otherwise the distance between random-access iterators.
+// Anything else (input streams, generators, forward lists) reports 0, which
+// the bar shows as an unknown total.
+template<typename IterT>
+std::size_t iterator_extent(IterT first, IterT last, std::random_access_iterator_tag) {
+    return last > first ? static_cast<std::size_t>(last - first) : 0;
+}
+template<typename IterT>
+std::size_t iterator_extent(IterT, IterT, std::input_iterator_tag) { return 0; }
+
+template<typename ContainerT>
+auto known_size(const ContainerT& container, int) -> decltype(static_cast<std::size_t>(container.size())) {
+    return static_cast<std::size_t>(container.size());
+}
+template<typename ContainerT>
+std::size_t known_size(const ContainerT& container, long) {
+    using iterator_t = decltype(std::begin(container));
+    return iterator_extent(std::begin(container), std::end(container),
+                           typename std::iterator_traits<iterator_t>::iterator_category());
+}
+} // namespace detail
+
 template<typename ContainerT>
 class progress_range {
     using iterator_t = decltype(std::begin(std::declval<ContainerT&>()));
     using const_iterator_t = decltype(std::begin(std::declval<const ContainerT&>()));
+    using counter_t = chunked_advancer<progress_bar<>>;
 
+    std::unique_ptr<ContainerT> owned_;  // set when built from a temporary
     ContainerT* container_;
     mutable progress_bar<> bar_;
+    mutable counter_t counter_;
 
 public:
-    explicit progress_range(ContainerT& container)
+    // chunk is the number of elements counted locally before the bar is
+    // advanced; 0 picks it adaptively from the observed rate. The range is
+    // never traversed up front: a range of unknown length shows count, rate
+    // and elapsed time until get_bar().set_total() is called.
+    explicit progress_range(ContainerT& container, std::size_t chunk = 1)
         : container_(&container)
-        , bar_(static_cast<std::size_t>(std::distance(std::begin(container), std::end(container)))) {}
+        , bar_(detail::known_size(container, 0))
+        , counter_(&bar_, chunk) {}
+
+    // Takes ownership of a temporary range, e.g. an iterator_range.
+    explicit progress_range(ContainerT&& container, std::size_t chunk = 1)
+        : owned_(new ContainerT(std::move(container)))
+        , container_(owned_.get())
+        , bar_(detail::known_size(*container_, 0))
+        , counter_(&bar_, chunk) {}
 
     // Move constructor
     progress_range(progress_range&& other) noexcept
-        : container_(other.container_)
-        , bar_(std::move(other.bar_)) {
+        : owned_(std::move(other.owned_))
+        , container_(other.container_)
+        , bar_(std::move(other.bar_))
+        , counter_(other.counter_, &bar_) {
         other.container_ = nullptr;
     }
 
-    auto begin() -> progress_iterator<iterator_t, progress_bar<>> {
-        return progress_iterator<iterator_t, progress_bar<>>(std::begin(*container_), std::end(*container_), &bar_);
+    ~progress_range() { counter_.flush(); }
+
+    auto begin() -> progress_iterator<iterator_t, counter_t> {
+        return progress_iterator<iterator_t, counter_t>(std::begin(*container_), std::end(*container_), &counter_);
+    }
+
+    auto end() -> progress_iterator<iterator_t, counter_t> {
+        return progress_iterator<iterator_t, counter_t>(std::end(*container_), std::end(*container_), nullptr);
+    }
+
+    auto begin() const -> progress_iterator<const_iterator_t, counter_t> {
+        return progress_iterator<const_iterator_t, counter_t>(std::begin(*container_), std::end(*container_), &counter_);
+    }
+
+    auto end() const -> progress_iterator<const_iterator_t, counter_t> {
+        return progress_iterator<const_iterator_t, counter_t>(std::end(*container_), std::end(*container_), nullptr);
+    }
+
+    progress_bar<>& get_bar() { return bar_; }
+};
+
+// Range whose elements carry a cost, e.g. file sizes. The total weight is
+// summed up front with one pass of cost_fn over the range (which must be
+// multi-pass); each element's cost is counted as the loop moves past it, in
+// adaptive batches.
+template<typename ContainerT, typename CostFn>
+class weighted_range {
+    using iterator_t = decltype(std::begin(std::declval<ContainerT&>()));
+
+    class counter_t {
+        chunked_advancer<progress_bar<>> batch_;
+        CostFn* cost_;
+
+    public:
+        counter_t(progress_bar<>* bar, CostFn* cost) : batch_(bar, 0), cost_(cost) {}
+        counter_t(const counter_t& other, progress_bar<>* bar, CostFn* cost)
+            : batch_(other.batch_, bar), cost_(cost) {}
+
+        template<typename T>
+        void advance_item(const T& item) {
+            batch_.advance_weighted(static_cast<std::size_t>((*cost_)(item)));
+        }
+        void flush() { batch_.flush(); }
+    };
+
+    ContainerT* container_;
+    CostFn cost_;
+    progress_bar<> bar_;
+    counter_t counter_;
+
+public:
+    weighted_range(ContainerT& container, CostFn cost)
+        : container_(&container)
+        , cost_(std::move(cost))
+        , bar_(detail::known_size(container, 0))
+        , counter_(&bar_, &cost_) {
+        std::size_t total = 0;
+        for (const auto& item : container) total += static_cast<std::size_t>(cost_(item));
+        bar_.set_total_weight(total);
     }
 
-    auto end() -> progress_iterator<iterator_t, progress_bar<>> {
-        return progress_iterator<iterator_t, progress_bar<>>(std::end(*container_), std::end(*container_), nullptr);
+    weighted_range(weighted_range&& other)
+        : container_(other.container_)
+        , cost_(std::move(other.cost_))
+        , bar_(std::move(other.bar_))
+        , counter_(other.counter_, &bar_, &cost_) {
+        other.container_ = nullptr;
     }
 
-    auto begin() const -> progress_iterator<const_iterator_t, progress_bar<>> {
-        return progress_iterator<const_iterator_t, progress_bar<>>(std::begin(*container_), std::end(*container_), &bar_);
+    ~weighted_range() { counter_.flush(); }
+
+    auto begin() -> progress_iterator<iterator_t, counter_t> {
+        return progress_iterator<iterator_t, counter_t>(std::begin(*container_), std::end(*container_), &counter_);
     }
 
-    auto end() const -> progress_iterator<const_iterator_t, progress_bar<>> {
-        return progress_iterator<const_iterator_t, progress_bar<>>(std::end(*container_), std::end(*container_), nullptr);
+    auto end() -> progress_iterator<iterator_t, counter_t> {
+        return progress_iterator<iterator_t, counter_t>(std::end(*container_), std::end(*container_), nullptr);
     }
 
     progress_bar<>& get_bar() { return bar_; }
@@ -671,16 +3140,524 @@ inline auto tqdm(ContainerT& container, const std::string& label) -> progress_ra
     return range;
 }
 
+// Iterator pair, e.g. tqdm(std::istream_iterator<T>(in), {}). Single-pass
+// iterators are fine: the range is walked once, by the loop.
+template<typename IterT, typename = typename std::iterator_traits<IterT>::iterator_category>
+inline auto tqdm(IterT first, IterT last) -> progress_range<iterator_range<IterT>> {
+    progress_range<iterator_range<IterT>> range(iterator_range<IterT>{first, last});
+    return range;
+}
+
+// Weighted iteration: percentage and ETA follow cost_fn(element), e.g.
+//   for (auto& f : tqdm::tqdm_weighted(files, [](const file& f) { return f.size; }))
+template<typename ContainerT, typename CostFn>
+inline auto tqdm_weighted(ContainerT& container, CostFn cost_fn) -> weighted_range<ContainerT, CostFn> {
+    weighted_range<ContainerT, CostFn> range(container, std::move(cost_fn));
+    return range;
+}
+
+// Chunked iteration: the bar is advanced every `chunk` elements, or at an
+// adaptively chosen interval when chunk is 0
+template<typename ContainerT>
+inline auto tqdm_chunked(ContainerT& container, std::size_t chunk = 0) -> progress_range<ContainerT> {
+    progress_range<ContainerT> range(container, chunk);
+    return range;
+}
+
+template<typename ContainerT>
+inline auto tqdm_chunked(ContainerT& container, const std::string& label,
+                         std::size_t chunk = 0) -> progress_range<ContainerT> {
+    progress_range<ContainerT> range(container, chunk);
+    range.get_bar().set_label(label);
+    return range;
+}
+
 // Create a manual progress bar
 inline progress_bar<> tqdm_manual(std::size_t total) {
     return progress_bar<>(total);
 }
 
+// Create a manual progress bar with a configured tracker (e.g. sharded)
+inline progress_bar<> tqdm_manual(std::size_t total, const tracker_options& options) {
+    return progress_bar<>(total, options);
+}
+
 template<typename ThemeT>
 inline progress_bar<> tqdm_manual(std::size_t total, ThemeT theme) {
     return progress_bar<>(total, std::unique_ptr<display_policy>(new bar_display<ThemeT>(theme)));
 }
 
+// Create a manual progress bar that counts bytes
+inline progress_bar<> tqdm_bytes(std::size_t total_bytes, unit_scale units = unit_scale::bytes_binary) {
+    tracker_options options;
+    options.units = units;
+    return progress_bar<>(total_bytes, options);
+}
+
+// =============================================================================
+// I/O Wrappers
+// =============================================================================
+
+// Forwards reads and writes to another streambuf and counts the bytes that
+// pass through. It has no buffer of its own: bulk transfers go straight
+// between the caller's memory and the wrapped streambuf. Counts are batched
+// and handed to the progress target every FLUSH_BYTES, on sync() and on
+// destruction, so character-at-a-time I/O does not advance per byte.
+template<typename ProgressT = progress_bar<>>
+class progress_streambuf : public std::streambuf {
+private:
+    static constexpr std::size_t FLUSH_BYTES = 64 * 1024;
+
+    std::streambuf* source_;
+    ProgressT* progress_;
+    std::size_t pending_{0};
+
+    void count(std::streamsize n) {
+        if (n <= 0) return;
+        pending_ += static_cast<std::size_t>(n);
+        if (pending_ >= FLUSH_BYTES) flush();
+    }
+
+    static bool is_eof(int_type c) noexcept { return traits_type::eq_int_type(c, traits_type::eof()); }
+
+protected:
+    int_type underflow() override { return source_->sgetc(); }
+
+    int_type uflow() override {
+        auto c = source_->sbumpc();
+        if (!is_eof(c)) count(1);
+        return c;
+    }
+
+    std::streamsize xsgetn(char_type* s, std::streamsize n) override {
+        auto got = source_->sgetn(s, n);
+        count(got);
+        return got;
+    }
+
+    std::streamsize showmanyc() override { return source_->in_avail(); }
+
+    int_type pbackfail(int_type c) override {
+        auto r = is_eof(c) ? source_->sungetc() : source_->sputbackc(traits_type::to_char_type(c));
+        if (!is_eof(r) && pending_) --pending_;
+        return r;
+    }
+
+    int_type overflow(int_type c) override {
+        if (is_eof(c)) return traits_type::not_eof(c);
+        auto r = source_->sputc(traits_type::to_char_type(c));
+        if (!is_eof(r)) count(1);
+        return r;
+    }
+
+    std::streamsize xsputn(const char_type* s, std::streamsize n) override {
+        auto put = source_->sputn(s, n);
+        count(put);
+        return put;
+    }
+
+    int sync() override {
+        flush();
+        return source_->pubsync();
+    }
+
+public:
+    progress_streambuf(std::streambuf* source, ProgressT& progress)
+        : source_(source), progress_(&progress) {}
+    ~progress_streambuf() override { flush(); }
+
+    progress_streambuf(const progress_streambuf&) = delete;
+    progress_streambuf& operator=(const progress_streambuf&) = delete;
+
+    // Hands the batched byte count to the progress target.
+    void flush() {
+        if (pending_) {
+            progress_->advance(pending_);
+            pending_ = 0;
+        }
+    }
+};
+
+// An istream reading through a progress_streambuf over another stream's
+// buffer, e.g. `progress_istream<> in(file, bar); in.read(buf, n);`.
+template<typename ProgressT = progress_bar<>>
+class progress_istream : public std::istream {
+private:
+    progress_streambuf<ProgressT> buf_;
+
+public:
+    progress_istream(std::istream& source, ProgressT& progress)
+        : std::istream(nullptr), buf_(source.rdbuf(), progress) {
+        rdbuf(&buf_);
+    }
+};
+
+// read(2) / write(2) that advance `progress` by the bytes actually moved.
+template<typename ProgressT>
+inline ssize_t counted_read(int fd, void* buf, std::size_t count, ProgressT& progress) {
+    auto n = ::read(fd, buf, count);
+    if (n > 0) progress.advance(static_cast<std::size_t>(n));
+    return n;
+}
+
+template<typename ProgressT>
+inline ssize_t counted_write(int fd, const void* buf, std::size_t count, ProgressT& progress) {
+    auto n = ::write(fd, buf, count);
+    if (n > 0) progress.advance(static_cast<std::size_t>(n));
+    return n;
+}
+
+// =============================================================================
+// Parallel Helpers
+// =============================================================================
+
+namespace detail {
+// Aim for ~16 chunks per worker so stragglers even out, but keep chunks small
+// enough that progress still moves steadily.
+inline std::size_t parallel_chunk_size(std::size_t count, std::size_t workers) {
+    auto chunk = count / (std::max<std::size_t>(workers, 1) * 16);
+    return std::max<std::size_t>(1, std::min<std::size_t>(chunk, std::size_t(1) << 16));
+}
+
+template<typename IterT>
+std::vector<IterT> chunk_boundaries(IterT first, std::size_t count, std::size_t chunk) {
+    std::vector<IterT> bounds;
+    bounds.reserve(count / chunk + 2);
+    bounds.push_back(first);
+    for (std::size_t done = 0; done < count;) {
+        auto step = std::min(chunk, count - done);
+        std::advance(first, static_cast<typename std::iterator_traits<IterT>::difference_type>(step));
+        done += step;
+        bounds.push_back(first);
+    }
+    return bounds;
+}
+
+// Bar for a parallel loop: per-thread counter shards and a background
+// renderer, so workers publish a chunk with one uncontended increment.
+inline progress_bar<> parallel_progress_bar(std::size_t count, std::size_t workers) {
+    tracker_options options;
+    options.shards = workers;
+    progress_bar<> bar(count, options);
+    bar.set_render_mode(render_mode::background);
+    return bar;
+}
+
+template<typename IterT, typename Func>
+void run_chunk(IterT first, IterT last, Func& func, progress_bar<>& bar) {
+    std::size_t done = 0;
+    for (; first != last; ++first) {
+        func(*first);
+        ++done;
+    }
+    bar.advance(done);
+}
+} // namespace detail
+
+// Thread-pool version, available in every language mode. Workers pull chunks
+// from a shared atomic index, run them without touching the bar, and publish
+// each finished chunk with a single advance(). The first exception thrown by
+// `func` is rethrown on the calling thread after all workers have stopped.
+template<typename ContainerT, typename Func>
+void parallel_for_each_with_progress(ContainerT& container, Func func, std::size_t threads = 0) {
+    auto count = static_cast<std::size_t>(std::distance(std::begin(container), std::end(container)));
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+
+    auto chunk = detail::parallel_chunk_size(count, threads);
+    auto bounds = detail::chunk_boundaries(std::begin(container), count, chunk);
+    auto chunks = bounds.size() - 1;
+    auto bar = detail::parallel_progress_bar(count, threads);
+
+    std::atomic<std::size_t> next{0};
+    std::atomic<bool> failed{false};
+    std::exception_ptr error;
+    std::mutex error_mutex;
+
+    auto worker = [&]() {
+        for (;;) {
+            auto c = next.fetch_add(1, std::memory_order_relaxed);
+            if (c >= chunks || failed.load(std::memory_order_relaxed)) return;
+            try {
+                detail::run_chunk(bounds[c], bounds[c + 1], func, bar);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(error_mutex);
+                if (!error) error = std::current_exception();
+                failed.store(true, std::memory_order_relaxed);
+                return;
+            }
+        }
+    };
+
+    std::vector<std::thread> pool;
+    auto helpers = std::min(threads, chunks) > 0 ? std::min(threads, chunks) - 1 : 0;
+    pool.reserve(helpers);
+    for (std::size_t t = 0; t < helpers; ++t) pool.emplace_back(worker);
+    worker();
+    for (auto& t : pool) t.join();
+
+    bar.finish();
+    if (error) std::rethrow_exception(error);
+}
+
+namespace detail {
+// One worker of parallel_for: the indices it still owns, [lo, hi), and its
+// progress and busy-time counters. The owner takes grains from the front;
+// idle workers steal the back half. The lock is held only to move bounds.
+struct alignas(64) steal_worker {
+    std::mutex mutex;
+    std::size_t lo{0};
+    std::size_t hi{0};
+    std::atomic<std::size_t> done{0};
+    std::atomic<int64_t> busy_ns{0};
+    std::atomic<int64_t> grain_start_ns{0};  // 0 while idle
+};
+
+class steal_pool {
+public:
+    steal_pool(std::size_t count, std::size_t workers, std::size_t grain)
+        : workers_(workers), count_(workers), grain_(grain) {
+        // Start from an even split; stealing evens out the rest.
+        for (std::size_t w = 0; w < workers; ++w) {
+            workers_[w].lo = count * w / workers;
+            workers_[w].hi = count * (w + 1) / workers;
+        }
+    }
+
+    std::size_t size() const noexcept { return count_; }
+    const steal_worker& worker(std::size_t w) const noexcept { return workers_[w]; }
+    steal_worker& worker(std::size_t w) noexcept { return workers_[w]; }
+
+    // Next grain for worker w, stolen from another worker if its own range
+    // is empty. A thief's range grows, but only with indices it has just cut
+    // from a victim under the victim's lock; nothing is ever handed back. So
+    // when a full scan finds every range empty, each unclaimed index belongs to
+    // a worker that is still running (possibly a thief between its two locks)
+    // and worker w can stop.
+    bool take(std::size_t w, std::size_t& lo, std::size_t& hi) {
+        if (take_own(w, lo, hi)) return true;
+        for (std::size_t i = 1; i < count_; ++i) {
+            auto& victim = workers_[(w + i) % count_];
+            std::size_t from, to;
+            {
+                std::lock_guard<std::mutex> lock(victim.mutex);
+                auto left = victim.hi - victim.lo;
+                if (left == 0) continue;
+                from = left > grain_ ? victim.lo + left / 2 : victim.lo;
+                to = victim.hi;
+                victim.hi = from;
+            }
+            {
+                std::lock_guard<std::mutex> lock(workers_[w].mutex);
+                workers_[w].lo = from;
+                workers_[w].hi = to;
+            }
+            return take_own(w, lo, hi);
+        }
+        return false;
+    }
+
+private:
+    aligned_array<steal_worker> workers_;  // one cache line each
+    std::size_t count_;
+    std::size_t grain_;
+
+    bool take_own(std::size_t w, std::size_t& lo, std::size_t& hi) {
+        auto& self = workers_[w];
+        std::lock_guard<std::mutex> lock(self.mutex);
+        if (self.lo >= self.hi) return false;
+        lo = self.lo;
+        hi = std::min(self.hi, self.lo + grain_);
+        self.lo = hi;
+        return true;
+    }
+};
+
+// The pool's tracker as bar_display sees it, with an ETA built from the
+// measured cost per item rather than the wall-clock rate: stealing keeps
+// every worker busy until fewer items than workers remain, so the rest
+// takes remaining * cost / min(workers, remaining). A rate-based ETA would
+// charge the idle time of earlier imbalance to the remaining work.
+struct steal_pool_tracker {
+    const progress_tracker<>& tracker;
+    const steal_pool& pool;
+
+    std::size_t current() const noexcept { return tracker.current(); }
+    std::size_t total() const noexcept { return tracker.total(); }
+    double percentage() const noexcept { return tracker.percentage(); }
+    double get_rate() const noexcept { return tracker.get_rate(); }
+    std::chrono::milliseconds elapsed() const noexcept { return tracker.elapsed(); }
+
+    std::chrono::milliseconds eta() const noexcept {
+        auto total = tracker.total(), done = tracker.current();
+        if (done >= total) return std::chrono::milliseconds(0);
+        double busy = 0.0, items = 0.0;
+        for (std::size_t w = 0; w < pool.size(); ++w) {
+            busy += static_cast<double>(pool.worker(w).busy_ns.load(std::memory_order_relaxed));
+            items += static_cast<double>(pool.worker(w).done.load(std::memory_order_relaxed));
+        }
+        if (items <= 0.0) return tracker.eta();
+        auto remaining = static_cast<double>(total - done);
+        auto lanes = std::min(static_cast<double>(pool.size()), remaining);
+        return std::chrono::milliseconds(static_cast<int64_t>(busy / items * remaining / lanes / 1e6));
+    }
+};
+
+// Aggregate bar followed by one block per worker whose height is the share
+// of the last frame interval that worker spent running items.
+class steal_pool_display : public display_policy {
+    const steal_pool& pool_;
+    bar_display<> bar_;
+    frame_buffer frame_;
+    std::vector<int64_t> last_busy_;
+    int64_t last_ns_;
+    int last_width_{0};
+
+    static const char* level_glyph(int level) noexcept {
+        static const char* const levels[9] = {" ", "\u2581", "\u2582", "\u2583", "\u2584",
+                                              "\u2585", "\u2586", "\u2587", "\u2588"};
+        return levels[level];
+    }
+
+    void compose(const progress_tracker<>& tracker) {
+        auto& bar = bar_.compose(steal_pool_tracker{tracker, pool_});
+        frame_.clear();
+        frame_.append(bar.data(), bar.size());
+        frame_.append(" util ");
+
+        auto now = steady_ns();
+        auto span = static_cast<double>(std::max<int64_t>(1, now - last_ns_));
+        last_ns_ = now;
+        double sum = 0.0;
+        for (std::size_t w = 0; w < pool_.size(); ++w) {
+            auto& worker = pool_.worker(w);
+            auto busy = worker.busy_ns.load(std::memory_order_relaxed);
+            auto start = worker.grain_start_ns.load(std::memory_order_relaxed);
+            if (start > 0 && start < now) busy += now - start;  // include the running grain
+            auto share = std::min(1.0, std::max(0.0, static_cast<double>(busy - last_busy_[w]) / span));
+            last_busy_[w] = busy;
+            sum += share;
+            frame_.append(level_glyph(static_cast<int>(std::nearbyint(share * 8))));
+        }
+        frame_.append(' ');
+        frame_.append_uint(static_cast<unsigned long long>(std::nearbyint(100.0 * sum / pool_.size())));
+        frame_.append('%');
+    }
+
+public:
+    explicit steal_pool_display(const steal_pool& pool)
+        : pool_(pool)
+        , frame_(256 + 3 * pool.size())
+        , last_busy_(pool.size(), 0)
+        , last_ns_(steady_ns()) {}
+
+    void set_label(const std::string& label) override {
+        bar_.set_label(label);
+        frame_.reserve(256 + 3 * pool_.size() + label.size());
+    }
+
+    void render(const progress_tracker<>& tracker) override {
+        compose(tracker);
+        auto width = static_cast<int>(frame_.size());
+        if (last_width_ > width) frame_.append(static_cast<std::size_t>(last_width_ - width), ' ');
+        last_width_ = width;
+        std::cout.put('\r');
+        std::cout.write(frame_.data(), static_cast<std::streamsize>(frame_.size()));
+        std::cout.flush();
+    }
+
+    void finish(const progress_tracker<>& tracker) override {
+        render(tracker);
+        std::cout << '\n';
+    }
+};
+
+template<typename Func>
+void run_work_stealing(std::size_t count, Func& body, std::size_t threads, std::size_t grain,
+                       const std::string& label) {
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    threads = std::max<std::size_t>(1, std::min(threads, count));
+    if (grain == 0) grain = std::max<std::size_t>(1, std::min<std::size_t>(count / (threads * 128), 1024));
+
+    steal_pool pool(count, threads, grain);
+    tracker_options options;
+    options.shards = threads;
+    progress_bar<> bar(count, options, std::unique_ptr<display_policy>(new steal_pool_display(pool)));
+    if (!label.empty()) bar.set_label(label);
+    bar.set_render_mode(render_mode::background);
+
+    std::atomic<bool> failed{false};
+    std::exception_ptr error;
+    std::mutex error_mutex;
+
+    auto worker = [&](std::size_t w) {
+        auto& self = pool.worker(w);
+        std::size_t lo, hi;
+        while (!failed.load(std::memory_order_relaxed) && pool.take(w, lo, hi)) {
+            auto start = steady_ns();
+            self.grain_start_ns.store(start, std::memory_order_relaxed);
+            auto i = lo;  // first index not completed
+            try {
+                for (; i < hi; ++i) body(i);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(error_mutex);
+                if (!error) error = std::current_exception();
+                failed.store(true, std::memory_order_relaxed);
+            }
+            self.grain_start_ns.store(0, std::memory_order_relaxed);
+            self.busy_ns.fetch_add(steady_ns() - start, std::memory_order_relaxed);
+            self.done.fetch_add(i - lo, std::memory_order_relaxed);
+            if (i > lo) bar.advance(i - lo);
+        }
+    };
+
+    std::vector<std::thread> pool_threads;
+    pool_threads.reserve(threads - 1);
+    for (std::size_t t = 1; t < threads; ++t) pool_threads.emplace_back(worker, t);
+    worker(0);
+    for (auto& t : pool_threads) t.join();
+
+    bar.finish();
+    if (error) std::rethrow_exception(error);
+}
+} // namespace detail
+
+// Work-stealing loop for irregular workloads, available in every language
+// mode. Each worker owns a share of the index range and takes `grain`
+// indices at a time (0 picks a grain from the size); a worker that runs out
+// steals the back half of another worker's share, so a few slow items do
+// not leave cores idle. The bar shows aggregate progress, an ETA from the
+// measured cost per item and a utilisation block per worker. The first
+// exception thrown by `func` is rethrown after all workers have stopped;
+// indices it skipped are not counted. The bounds may differ in type: the
+// index passed to `func` has their common type.
+//
+//   tqdm::parallel_for(0, files.size(), [&](std::size_t i) { index(files[i]); });
+template<typename FirstT, typename LastT, typename Func,
+         typename = typename std::enable_if<std::is_integral<FirstT>::value &&
+                                            std::is_integral<LastT>::value>::type>
+void parallel_for(FirstT first_bound, LastT last_bound, Func func, std::size_t threads = 0,
+                  std::size_t grain = 0, const std::string& label = "") {
+    using IndexT = typename std::common_type<FirstT, LastT>::type;
+    auto first = static_cast<IndexT>(first_bound);
+    auto last = static_cast<IndexT>(last_bound);
+    if (!(first < last)) return;
+    auto body = [&func, first](std::size_t i) { func(static_cast<IndexT>(first + static_cast<IndexT>(i))); };
+    detail::run_work_stealing(static_cast<std::size_t>(last - first), body, threads, grain, label);
+}
+
+// Same over the elements of a random-access container.
+template<typename ContainerT, typename Func>
+void parallel_for(ContainerT& container, Func func, std::size_t threads = 0,
+                  std::size_t grain = 0, const std::string& label = "") {
+    auto first = std::begin(container);
+    auto count = static_cast<std::size_t>(std::end(container) - first);
+    if (count == 0) return;
+    auto body = [&func, first](std::size_t i) {
+        func(first[static_cast<typename std::iterator_traits<decltype(first)>::difference_type>(i)]);
+    };
+    detail::run_work_stealing(count, body, threads, grain, label);
+}
+
 // =============================================================================
 // C++14 and beyond enhancements
 // =============================================================================
@@ -697,21 +3674,30 @@ inline auto make_progress_bar(Args&&... args) {
 // C++17 specific features
 // =============================================================================
 
-#ifdef TQDM_CPP17
-template<typename ExecutionPolicy, typename ContainerT, typename Func>
+#ifdef TQDM_HAS_EXECUTION
+// Execution-policy version: the range is split into chunks up front and the
+// policy runs the chunks, each publishing its progress once when it is done.
+template<typename ExecutionPolicy, typename ContainerT, typename Func,
+         typename = typename std::enable_if<
+             std::is_execution_policy<typename std::decay<ExecutionPolicy>::type>::value>::type>
 void parallel_for_each_with_progress(ExecutionPolicy&& policy,
                                     ContainerT& container,
                                     Func func) {
-    auto pbar = tqdm_manual(container.size());
-    std::mutex pbar_mutex;
+    auto count = static_cast<std::size_t>(std::distance(std::begin(container), std::end(container)));
+    auto workers = std::max(1u, std::thread::hardware_concurrency());
+
+    auto chunk = detail::parallel_chunk_size(count, workers);
+    auto bounds = detail::chunk_boundaries(std::begin(container), count, chunk);
+    std::vector<std::size_t> chunks(bounds.size() - 1);
+    for (std::size_t c = 0; c < chunks.size(); ++c) chunks[c] = c;
+    auto pbar = detail::parallel_progress_bar(count, workers);
 
     std::for_each(std::forward<ExecutionPolicy>(policy),
-                  container.begin(), container.end(),
-                  [&func, &pbar, &pbar_mutex](auto&& item) {
-                      func(item);
-                      std::lock_guard<std::mutex> lock(pbar_mutex);
-                      pbar.advance();
+                  chunks.begin(), chunks.end(),
+                  [&func, &pbar, &bounds](std::size_t c) {
+                      detail::run_chunk(bounds[c], bounds[c + 1], func, pbar);
                   });
+    pbar.finish();
 }
 #endif
 
@@ -730,16 +3716,313 @@ concept ProgressRange = std::ranges::forward_range<R> &&
         { std::ranges::size(r) } -> std::convertible_to<std::size_t>;
     };
 
+// A view that shows progress while it is iterated. The bar is created by the
+// first begin(), with ranges::size() as its total when the range is sized
+// (and an unknown total otherwise). Later begin() calls, e.g. from empty() or
+// front(), reuse it; copies of the view made after the first begin() share
+// it. The iterator counts elements itself and hands them to the bar in
+// adaptive batches, so the per-element cost is an increment and a compare.
+// Comparing with end() has no side effects: an iterator publishes its count
+// when destroyed, and the bar is finished once the view and its iterators
+// are gone, e.g. at the end of a range-for over views::with_progress.
+template<std::ranges::input_range V>
+    requires std::ranges::view<V>
+class progress_view : public std::ranges::view_interface<progress_view<V>> {
+    struct state {
+        progress_bar<> bar;
+        chunked_advancer<progress_bar<>> counter;
+        explicit state(std::size_t total) : bar(total), counter(&bar, 0) {}
+        ~state() { counter.flush(); }  // the bar then finishes as it is destroyed
+    };
+
+    V base_ = V();
+    std::string label_;
+    std::shared_ptr<state> state_;
+
+    class sentinel;
+
+    class iterator {
+        friend class sentinel;
+        std::ranges::iterator_t<V> current_{};
+        std::shared_ptr<state> state_;
+        std::size_t pending_{0};
+        std::size_t chunk_{1};
+
+        void flush() {
+            if (pending_ == 0 || !state_) return;
+            state_->counter.advance(pending_);
+            chunk_ = state_->counter.chunk();
+            pending_ = 0;
+        }
+
+    public:
+        using iterator_concept = std::conditional_t<std::ranges::forward_range<V>,
+                                                    std::forward_iterator_tag, std::input_iterator_tag>;
+        using iterator_category = std::input_iterator_tag;
+        using value_type = std::ranges::range_value_t<V>;
+        using difference_type = std::ranges::range_difference_t<V>;
+
+        iterator() = default;
+        iterator(std::ranges::iterator_t<V> current, std::shared_ptr<state> s)
+            : current_(std::move(current)), state_(std::move(s)) {}
+
+        // Copies start with nothing pending, so a count is reported once,
+        // by the iterator that did the walking.
+        iterator(const iterator& other) : current_(other.current_), state_(other.state_), chunk_(other.chunk_) {}
+        iterator(iterator&& other) noexcept
+            : current_(std::move(other.current_)), state_(std::move(other.state_))
+            , pending_(std::exchange(other.pending_, 0)), chunk_(other.chunk_) {}
+        iterator& operator=(const iterator& other) {
+            if (this != &other) {
+                flush();
+                current_ = other.current_;
+                state_ = other.state_;
+                chunk_ = other.chunk_;
+            }
+            return *this;
+        }
+        iterator& operator=(iterator&& other) noexcept {
+            if (this != &other) {
+                flush();
+                current_ = std::move(other.current_);
+                state_ = std::move(other.state_);
+                pending_ = std::exchange(other.pending_, 0);
+                chunk_ = other.chunk_;
+            }
+            return *this;
+        }
+        // Publishes everything this iterator counted, including the partial
+        // batch the advancer still holds, so the bar is exact once a loop
+        // ends or breaks.
+        ~iterator() {
+            flush();
+            if (state_) state_->counter.flush();
+        }
+
+        decltype(auto) operator*() const { return *current_; }
+
+        iterator& operator++() {
+            ++current_;
+            if (++pending_ >= chunk_) flush();
+            return *this;
+        }
+        void operator++(int) requires (!std::ranges::forward_range<V>) { ++*this; }
+        iterator operator++(int) requires std::ranges::forward_range<V> {
+            auto tmp = *this;
+            ++*this;
+            return tmp;
+        }
+
+        friend bool operator==(const iterator& a, const iterator& b)
+            requires std::equality_comparable<std::ranges::iterator_t<V>> {
+            return a.current_ == b.current_;
+        }
+    };
+
+    class sentinel {
+        std::ranges::sentinel_t<V> end_{};
+
+    public:
+        sentinel() = default;
+        explicit sentinel(std::ranges::sentinel_t<V> end) : end_(std::move(end)) {}
+
+        bool reached(const iterator& it) const { return it.current_ == end_; }
+
+        friend bool operator==(const iterator& it, const sentinel& s) { return s.reached(it); }
+    };
+
+public:
+    progress_view() requires std::default_initializable<V> = default;
+    explicit progress_view(V base, std::string label = "")
+        : base_(std::move(base)), label_(std::move(label)) {}
+
+    V base() const& requires std::copy_constructible<V> { return base_; }
+    V base() && { return std::move(base_); }
+
+    iterator begin() {
+        if (!state_) {
+            std::size_t total = 0;
+            if constexpr (std::ranges::sized_range<V>) total = static_cast<std::size_t>(std::ranges::size(base_));
+            state_ = std::make_shared<state>(total);
+            if (!label_.empty()) state_->bar.set_label(label_);
+        }
+        return iterator(std::ranges::begin(base_), state_);
+    }
+
+    sentinel end() { return sentinel(std::ranges::end(base_)); }
+
+    auto size() requires std::ranges::sized_range<V> { return std::ranges::size(base_); }
+};
+
+template<typename R>
+progress_view(R&&) -> progress_view<std::views::all_t<R>>;
+template<typename R>
+progress_view(R&&, std::string) -> progress_view<std::views::all_t<R>>;
+
 namespace views {
+// with_progress(r), r | with_progress, or r | with_progress("label").
+// Rvalue ranges are owned through views::all.
 struct with_progress_fn {
-    template<ProgressRange R>
-    auto operator()(R&& range) const {
-        return tqdm(std::forward<R>(range));
+    struct closure {
+        std::string label;
+        template<std::ranges::viewable_range R>
+            requires std::ranges::input_range<R>
+        friend auto operator|(R&& range, const closure& c) {
+            return progress_view(std::views::all(std::forward<R>(range)), c.label);
+        }
+    };
+
+    template<std::ranges::viewable_range R>
+        requires std::ranges::input_range<R>
+    auto operator()(R&& range, std::string label = "") const {
+        return progress_view(std::views::all(std::forward<R>(range)), std::move(label));
+    }
+
+    closure operator()(std::string label) const { return closure{std::move(label)}; }
+    closure operator()(const char* label) const { return closure{label}; }
+
+    template<std::ranges::viewable_range R>
+        requires std::ranges::input_range<R>
+    friend auto operator|(R&& range, const with_progress_fn&) {
+        return progress_view(std::views::all(std::forward<R>(range)));
     }
 };
 inline constexpr with_progress_fn with_progress{};
 } // namespace views
 
+#ifdef TQDM_HAS_COROUTINES
+// Progress for many concurrent coroutine tasks. Tasks report through a
+// progress_handle, which is one relaxed add on a per-thread counter shard:
+// no lock, no clock read and no write to the terminal on the completing
+// task. The executor drives the display by calling tick() from its timer;
+// tick() also resumes coroutines waiting on done().
+//
+//   tqdm::async_progress progress(jobs.size());
+//   for (auto& job : jobs) spawn(run(job, progress.handle()));
+//   executor.every(50ms, [&] { progress.tick(); });
+//   co_await progress.done();
+class async_progress {
+public:
+    class handle_type {
+        progress_tracker<>* tracker_{nullptr};
+        friend class async_progress;
+        explicit handle_type(progress_tracker<>* tracker) noexcept : tracker_(tracker) {}
+
+    public:
+        handle_type() = default;
+        void complete(std::size_t n = 1) const noexcept { if (tracker_) tracker_->advance(n); }
+    };
+
+    // Awaitable that resumes once all work has completed (or finish() was
+    // called). Resumption happens inside tick() or finish(), on whichever
+    // thread called it.
+    class done_awaiter {
+        async_progress* progress_;
+
+    public:
+        explicit done_awaiter(async_progress* progress) noexcept : progress_(progress) {}
+        bool await_ready() const noexcept { return progress_->done_now(); }
+        bool await_suspend(std::coroutine_handle<> waiter) {
+            std::lock_guard<std::mutex> lock(progress_->waiters_mutex_);
+            if (progress_->done_now()) return false;
+            progress_->waiters_.push_back(waiter);
+            return true;
+        }
+        void await_resume() const noexcept {}
+    };
+
+    explicit async_progress(std::size_t total, std::unique_ptr<display_policy> display = nullptr)
+        : async_progress(total, sharded_options(), std::move(display)) {}
+
+    async_progress(std::size_t total, const tracker_options& options,
+                   std::unique_ptr<display_policy> display = nullptr)
+        : tracker_(total, options)
+        , display_(display ? std::move(display)
+                           : std::unique_ptr<display_policy>(detail::default_display<display_policy>::make())) {
+        active_ = display_ && (is_tty() || !detail::display_requires_tty(*display_, 0));
+    }
+
+    ~async_progress() { finish(); }
+
+    async_progress(const async_progress&) = delete;
+    async_progress& operator=(const async_progress&) = delete;
+
+    // Copyable and cheap to pass to every task; valid while *this lives.
+    handle_type handle() noexcept { return handle_type(&tracker_); }
+
+    done_awaiter done() noexcept { return done_awaiter(this); }
+
+    void set_label(const std::string& label) {
+        std::lock_guard<std::mutex> lock(render_mutex_);
+        display_->set_label(label);
+    }
+
+    void set_refresh(const refresh_options& options) { scheduler_.configure(options); }
+
+    // Renders a frame if the refresh policy allows one and resumes done()
+    // waiters once everything has completed. Returns true when done. Safe to
+    // call from several executor threads; extra concurrent calls skip the frame.
+    bool tick() {
+        auto now = detail::steady_ns();
+        if (active_ && scheduler_.claim(now, tracker_)) {
+            std::unique_lock<std::mutex> lock(render_mutex_, std::try_to_lock);
+            if (lock.owns_lock() && !finished_.load(std::memory_order_acquire)) {
+                display_->render(tracker_);
+                scheduler_.rendered(now, detail::steady_ns(), tracker_.current());
+            }
+        }
+        bool complete = done_now();
+        if (complete) resume_waiters();
+        return complete;
+    }
+
+    // Draws the final frame and releases all done() waiters, complete or not.
+    void finish() {
+        bool expected = false;
+        if (finished_.compare_exchange_strong(expected, true, std::memory_order_acq_rel)) {
+            if (active_) {
+                std::lock_guard<std::mutex> lock(render_mutex_);
+                display_->finish(tracker_);
+            }
+        }
+        resume_waiters();
+    }
+
+    const progress_tracker<>& tracker() const noexcept { return tracker_; }
+
+private:
+    progress_tracker<> tracker_;
+    std::unique_ptr<display_policy> display_;
+    detail::refresh_scheduler scheduler_;
+    std::mutex render_mutex_;
+    std::mutex waiters_mutex_;
+    std::vector<std::coroutine_handle<>> waiters_;
+    std::atomic<bool> finished_{false};
+    bool active_{false};
+
+    static tracker_options sharded_options() {
+        tracker_options options;
+        options.shards = std::max(1u, std::thread::hardware_concurrency());
+        return options;
+    }
+
+    bool done_now() const noexcept {
+        if (finished_.load(std::memory_order_acquire)) return true;
+        auto total = tracker_.total();
+        return total > 0 && tracker_.current() >= total;
+    }
+
+    void resume_waiters() {
+        std::vector<std::coroutine_handle<>> ready;
+        {
+            std::lock_guard<std::mutex> lock(waiters_mutex_);
+            ready.swap(waiters_);
+        }
+        for (auto waiter : ready) waiter.resume();
+    }
+};
+#endif // TQDM_HAS_COROUTINES
+
 #endif
 
 } // namespace tqdm